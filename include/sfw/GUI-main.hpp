@@ -3,15 +3,30 @@
 
 #include "sfw/Theme.hpp"
 #include "sfw/Gfx/Render.hpp"
+#include "sfw/Gfx/FrameCapture.hpp"
 #include "sfw/Layouts/VBox.hpp"
+#include "sfw/util/worker_pool.hpp"
 
 #include <SFML/System/Vector2.hpp>
 #include <SFML/Graphics/RenderWindow.hpp>
+#include <SFML/Graphics/RenderTexture.hpp>
+#include <SFML/Graphics/View.hpp>
+#include <SFML/Graphics/Rect.hpp>
 #include <SFML/Window/Event.hpp>
 #include <SFML/Window/Cursor.hpp>
+#include <SFML/System/Clock.hpp>
+#include <SFML/System/Time.hpp>
 
 #include <string>
 #include <map>
+#include <optional>
+#include <vector>
+#include <functional>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <thread>
+#include <memory>
 #include <system_error>
 
 namespace sfw
@@ -25,8 +40,22 @@ namespace sfw
 class GUI: public VBox
 {
 public:
-    GUI(sf::RenderWindow& window, const sfw::Theme::Cfg& themeCfg = Theme::DEFAULT,
+    /**
+     * The target is typically the app's sf::RenderWindow, but it can be any
+     * render target (e.g. an sf::RenderTexture, to be composited into a 3D
+     * scene, or only updated when the GUI has changed, see update()).
+     *
+     * If the target is not an sf::RenderWindow, the window-specific features
+     * are disabled: close() won't close anything, setMouseCursor() only
+     * records the cursor type (see getMouseCursor()), and run() can't be used
+     * (as there's no window to get the events from; call process() with the
+     * events (in the target's pixels) of wherever the GUI is shown instead).
+     * `own_the_window` then only controls the background clearing (see
+     * Theme::clearBackground).
+     */
+    GUI(sf::RenderTarget& target, const sfw::Theme::Cfg& themeCfg = Theme::DEFAULT,
         bool own_the_window = true);
+    ~GUI();
 
     /**
      * Return true if no errors & has not been closed.
@@ -45,9 +74,195 @@ public:
     bool process(const sf::Event& event);
 
     /**
-     * Draw the entire GUI to the backend (i.e. SFML)
+     * Draw the GUI to the backend (i.e. SFML)
+     *
+     * The widgets are drawn into a persistent framebuffer, and only the parts
+     * that have changed since the last call (see Widget::invalidate() and
+     * damage()) are repainted there. The framebuffer is then copied to the
+     * window (which is a single textured quad, so it's cheap). (With the render
+     * thread running, all that is done by that thread; see startRenderThread().)
+     *
+     * Repainting doesn't allocate memory in the steady state. (With the lib
+     * built with SFW_ALLOC_GUARD defined, this is also verified, and any
+     * allocation while repainting (after the first frame) is reported as an
+     * error, and trips an assert in debug builds. See sfw/util/alloc_guard.hpp.)
+     *
+     * Returns false if nothing had to be repainted. If nothing else has been
+     * drawn to the window either, the app can then skip the (possibly vsync-
+     * throttled) window.display() call, too, as the window content is still
+     * the same.
+     */
+    bool render();
+
+    /**
+     * Like render(), but only repaints the framebuffer, without drawing it
+     * to the target (to skip that when it has returned false, or to draw
+     * getTexture() some other way)
+     */
+    bool update();
+
+    /**
+     * Apply the pending layout changes (see WidgetContainer::updateLayout())
+     *
+     * Resizing or adding widgets only marks their containers for relayout,
+     * which is then done in one batch, so building or changing a large GUI
+     * doesn't cascade through the whole tree for every single change.
+     * Called by process() (so that the events hit the widgets where they
+     * are now), and by update() and render(), so this is only needed to get
+     * the new geometry of the containers right away.
+     */
+    void updateLayout();
+
+    /**
+     * The framebuffer of the GUI (with alpha-premultiplied content, i.e. to be
+     * drawn with sf::BlendMode(One, OneMinusSrcAlpha))
+     * (Only valid after the first render() or update().)
+     */
+    const sf::Texture& getTexture() const { return m_framebuffer.getTexture(); }
+
+    /**
+     * The target the GUI is drawn to, and the same as an sf::RenderWindow, or
+     * nullptr, if it's not a window
+     */
+    sf::RenderTarget& getTarget() const { return m_target; }
+    sf::RenderWindow* getWindow() const { return m_window; }
+
+    /**
+     * Threaded rendering
+     *
+     * startRenderThread() moves the drawing to a dedicated thread: render()
+     * then only builds a snapshot of the frame (its draw list, see
+     * gfx::DrawList) and hands it over, and the render thread submits that
+     * to the framebuffer, composites it to the target, and (for a window)
+     * calls display(). So the app's thread can go on (e.g. processing the
+     * events of the next frame) while the previous one is being drawn and
+     * displayed.
+     *
+     * It's double-buffered: a snapshot is built while the previous one is
+     * being submitted; render() waits only if the one before that hasn't
+     * been picked up by the render thread yet (none can be dropped, as they
+     * only repaint the damaged areas). Building a snapshot and submitting
+     * one don't overlap, though (as they share the resources, like the glyph
+     * pages of the fonts), but event processing, posted tasks, and anything
+     * the app does between render() calls do.
+     *
+     * Rules, while the render thread is running:
+     * - Changing the widgets (event processing, setters, adding, removing
+     *   them etc.) is safe: the snapshots don't refer to them.
+     * - The textures (and shaders) used by the widgets (or the Theme) must
+     *   stay alive, and unchanged, while a snapshot using them may be in
+     *   flight: call waitForRenderThread() before changing or destroying one.
+     *   (setTheme() does this itself.)
+     * - The target belongs to the render thread: don't draw to it, display()
+     *   it, or change its view from other threads. (The GUI keeps using the
+     *   view it had at startRenderThread().) Window events can still be
+     *   processed on the app's thread, as usual.
+     * - Only what's drawn via the renderer (ctx.renderer) is captured in the
+     *   snapshots; direct drawing to ctx.target (e.g. in DrawHost hooks) is
+     *   lost.
+     *
+     * The target is cleared before compositing the GUI to it, then
+     * `underlay` (if any) is called (on the render thread), to draw what
+     * should be behind the GUI.
+     *
+     * stopRenderThread() waits until every snapshot has been submitted, and
+     * returns to drawing directly (in render()). It's also called by close()
+     * and the destructor.
+     */
+    void startRenderThread(std::function<void(sf::RenderTarget&)> underlay = {});
+    void stopRenderThread();
+    void waitForRenderThread(); // Until every snapshot has been submitted
+    bool renderThreadRunning() const { return m_renderThread.joinable(); }
+
+    /**
+     * Build the frames on `threads` worker threads (plus the calling one)
+     * 0 (the default) turns it off.
+     *
+     * The (visible) children of the GUI are drawn in parallel, each by its
+     * own renderer, and their draw lists are then appended in order (so the
+     * result is the same, only the batching doesn't reach across them). So
+     * it's useful for large trees with several top-level containers.
+     *
+     * The same limits apply as for the render thread (see there): only the
+     * drawing via ctx.renderer is captured, so the offscreen layout caches
+     * (see Layout::setCaching()) are not used by the parallel parts, and
+     * direct drawing to ctx.target (e.g. in DrawHost hooks) is lost. Also,
+     * widgets must only use fonts via the renderer, or with its font lock
+     * held (see gfx::Renderer::lockFonts()). (Invalidating widgets while
+     * being drawn is fine.)
+     */
+    void setParallelBuild(unsigned threads);
+
+    /**
+     * Record what's on the target (e.g. for session logs, or audits)
+     *
+     * The target is read back right after compositing the GUI to it (in
+     * render(), or on the render thread), asynchronously, and the frames are
+     * encoded on a worker thread, as a sequence of PNG files, or a Y4M video
+     * (see gfx::FrameCapture for the details). Frames the readback or the
+     * encoder can't keep up with are dropped, never waited for.
+     *
+     * captureStats() reports the frames captured, written and dropped, and
+     * the time the capturing has added to the rendering (also after
+     * stopCapture(), for the last session).
+     *
+     * Returns false if it can't be started (errors are printed to cerr).
+     */
+    bool startCapture(const std::string& path,
+                      gfx::FrameCapture::Format format = gfx::FrameCapture::Format::PNG, unsigned fps = 30);
+    void stopCapture(); // Finishes encoding the frames captured so far (may block for that)
+    bool capturing() const { return (bool)m_capture; }
+    gfx::FrameCapture::Stats captureStats() const;
+
+    /**
+     * Mark an area of the window (in world coordinates, i.e. what the widgets
+     * are drawn with) to be repainted on the next render() call
+     * Without an area, the entire window will be repainted (and all the
+     * offscreen layout caches rebuilt, see Layout::setCaching()).
+     * (Widgets don't need to call this directly, see Widget::invalidate().)
+     */
+    void damage(const sf::FloatRect& area);
+    void damage();
+
+    /**
+     * Time left until the next render() call would actually repaint something
+     * Zero if it's already due (e.g. something has changed, or there are
+     * posted tasks to run), and std::nullopt if nothing has been scheduled
+     * at all, i.e. the GUI will stay the same until the next input event.
+     */
+    std::optional<sf::Time> nextFrameDeadline() const;
+
+    /**
+     * Run a task on the GUI thread (at the start of the next render() call)
+     * This is the safe way of changing the widgets from other threads.
+     * (Can be called from any thread.)
+     */
+    void post(std::function<void()> task);
+
+    /**
+     * A complete event loop (for apps where the GUI is the main thing)
+     *
+     * Runs until the GUI is closed (or the window is closed by other means).
+     * (Needs a window target; returns immediately otherwise.)
+     * Renders (and displays the window) only when something has changed, and
+     * otherwise just waits for the next input event, or the next scheduled
+     * repaint (like a cursor blink), so an idle GUI uses (almost) no CPU.
+     *
+     * The optional `eventHook` is called with every event after processing
+     * it by the GUI.
+     */
+    void run(const std::function<void(const sf::Event&)>& eventHook = {});
+
+    /**
+     * Configure how run() waits when there's nothing to do
+     * SFML can't wake up a blocking window.waitEvent() from other threads,
+     * so run() checks for events (and posted tasks) every `pollInterval`
+     * (which is then also the max. input latency) while waiting. If
+     * `blockWhenIdle` is true, it does use the blocking waitEvent() when
+     * nothing has been scheduled, for really zero CPU usage, but then
+     * posted tasks will only run after the next input event.
      */
-    void render();
+    void setIdlePolling(sf::Time pollInterval, bool blockWhenIdle = false);
 
     /**
      * Shut down the GUI (but not the window by default)
@@ -77,10 +292,15 @@ public:
 
     /**
      * Change the mouse pointer for the GUI window
+     * (Without a window, only the type is stored, for the app to show it.)
      */
     void setMouseCursor(sf::Cursor::Type cursorType);
+    sf::Cursor::Type getMouseCursor() const { return m_cursorType; }
 
 private:
+//----------------------
+friend class Widget;
+//----------------------
 
     /**
      * "Soft-reset" the GUI state, keeping the current config & widgets
@@ -98,14 +318,118 @@ private:
      */
     sf::Vector2f convertMousePosition(int x, int y) const;
 
+    /**
+     * Run the tasks post()-ed so far (from other threads)
+     */
+    void runPostedTasks();
+
+    /**
+     * Invalidate the widget after `delay` (see Widget::invalidate(delay))
+     * If it's already scheduled, the earlier one wins.
+     */
+    void scheduleRepaint(const Widget* widget, sf::Time delay);
+
+    /**
+     * Invalidate the widgets whose scheduled repaint is due
+     */
+    void applyScheduledRepaints();
+
+    /**
+     * Repaint the damaged area of the framebuffer
+     * Returns false if there was nothing to repaint.
+     */
+    bool repaint();
+
+    /**
+     * Draw the widget tree via `renderer`, as one frame
+     */
+    void record(gfx::Renderer& renderer);
+    void recordInParallel(gfx::Renderer& renderer); // (See setParallelBuild().)
+    void recordPart(size_t index); // (On a worker thread.)
+
+    /**
+     * Draw the framebuffer to the target
+     */
+    void composite();
+
+    /**
+     * The view the GUI is drawn with (see startRenderThread())
+     */
+    const sf::View& guiView() const { return renderThreadRunning() ? m_threadView : m_target.getView(); }
+
+    // Threaded rendering
+    struct Frame // The snapshot handed over to the render thread
+    {
+        gfx::DrawList list;  // (Its view is restricted to the damaged area.)
+        sf::IntRect pixels;  // The damaged area (to be cleared first)
+        sf::Color clearColor;
+        sf::Vector2u size;   // Of the target
+    };
+    void renderThread();
+    void present(const Frame& frame);
+
     std::error_code m_error;
-    sf::RenderWindow& m_window;
-    bool m_own_the_window;
+    sf::RenderTarget& m_target;
+    sf::RenderWindow* m_window;      // Same as m_target, if that's a window (or nullptr)
+    sf::RenderTexture m_framebuffer; // The persistent "retained" image of the GUI
+    gfx::Renderer m_renderer;        // (Draws to the framebuffer.)
+    bool m_own_the_window;           // (Or the target, if it's not a window.)
     sfw::Theme::Cfg m_themeCfg;
     sf::Cursor::Type m_cursorType;
     std::map<std::string, Widget*> widgets;
 
     bool m_closed = false;
+
+    // Damage tracking
+    std::optional<sf::FloatRect> m_damage; // Union of the damaged areas since the last render()
+    bool m_fullRepaint = true;
+    sf::View m_lastView; // To detect view changes (which would invalidate everything)
+    sf::Vector2u m_lastSize; // To detect resizing (ditto)
+    bool m_warmedUp = false; // For the allocation guard: the first repaint may allocate
+
+    // Frame scheduling
+    struct ScheduledRepaint { sf::Time due; const Widget* widget; };
+    std::vector<ScheduledRepaint> m_scheduledRepaints;
+    sf::Clock m_clock; // The time base for the scheduled repaints
+    sf::Time m_idlePollInterval = sf::milliseconds(10);
+    bool m_blockWhenIdle = false;
+
+    // Tasks posted from other threads
+    std::vector<std::function<void()>> m_postedTasks;
+    mutable std::mutex m_postedTasksMutex;
+
+    // Threaded rendering (see startRenderThread())
+    std::thread m_renderThread;
+    Frame m_frames[2];               // The one being built, and the one being submitted
+    bool m_framePending = false;     // m_frames[0] is ready to be picked up
+    bool m_frameInFlight = false;    // m_frames[1] is being submitted
+    bool m_stopRenderThread = false;
+    std::mutex m_frameMutex;         // For the 3 flags above
+    std::condition_variable m_frameChanged;
+    std::mutex m_resourceMutex;      // Building and submitting frames don't overlap
+    gfx::NullTarget m_recordTarget;  // Stands in for the target while building frames
+    gfx::Renderer m_recorder;        // (Only records, to m_recordTarget.)
+    sf::View m_threadView;
+    std::function<void(sf::RenderTarget&)> m_underlay;
+
+    // Parallel frame building (see setParallelBuild())
+    struct Part // Renderer for a subtree
+    {
+        gfx::NullTarget target{{1, 1}}; // (With the view & size of the real target.)
+        gfx::Renderer renderer{target};
+    };
+    std::unique_ptr<WorkerPool> m_workers;
+    std::vector<std::unique_ptr<Part>> m_parts; // Pooled
+    std::vector<const Widget*> m_partRoots;     // The children being drawn (in order)
+    sf::RenderStates m_partStates;
+    std::function<void(size_t)> m_partJob;
+    std::atomic<size_t> m_partAllocations{0}; // Made by the parts in the last repaint (see AllocationGuard)
+    std::mutex m_fontMutex;   // For the part renderers (see gfx::Renderer::setFontLock())
+    std::mutex m_damageMutex; // For Widget::invalidate()
+
+    // Frame capture (see startCapture())
+    std::unique_ptr<gfx::FrameCapture> m_capture; // (Used by the render thread, if running.)
+    gfx::FrameCapture::Stats m_captureStats;      // Of the last capture, after it's stopped
 };
 
 } // namespace
@@ -17,11 +17,15 @@
 #include "sfw/Widgets/ImageButton.hpp"
 #include "sfw/Widgets/TextBox.hpp"
 #include "sfw/Widgets/DrawHost.hpp"
+#include "sfw/Widgets/Canvas.hpp"
 
 // Layout containers
 #include "sfw/Layouts/VBox.hpp"
 #include "sfw/Layouts/HBox.hpp"
 #include "sfw/Layouts/Form.hpp"
+#include "sfw/Layouts/Flex.hpp"
+#include "sfw/Layouts/Grid.hpp"
+#include "sfw/Layouts/ConstraintLayout.hpp"
 
 // Misc
 #include "sfw/util/hex2color.hpp"
@@ -0,0 +1,152 @@
+#ifndef SFW_FRAMECAPTURE_HPP
+#define SFW_FRAMECAPTURE_HPP
+
+#include <SFML/Graphics/RenderTarget.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <SFML/System/Clock.hpp>
+#include <SFML/System/Time.hpp>
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+#include <cstddef>
+
+namespace sfw
+{
+namespace gfx
+{
+
+//============================================================================
+/**
+ * Recording the frames of a render target (e.g. for session logs, audits)
+ *
+ * The pixels are read back asynchronously: capture() only queues a copy of
+ * the framebuffer to one of a small ring of GL pixel buffers (with a fence),
+ * and picks up the earlier ones the GPU is already done with, without ever
+ * waiting for it. The frames are then encoded on a worker thread, either to
+ * a sequence of PNG files, or to a raw (YUV 4:2:0) Y4M video stream.
+ *
+ * Frames are taken as they are rendered, at most `fps` per second. As idle
+ * GUIs are not rendered at all, the frames are numbered by their time since
+ * the start (at `fps`), so the PNG file names have gaps then, and the Y4M
+ * stream repeats the last frame, to keep the timing right.
+ *
+ * A frame is dropped (and counted; see Stats), rather than stalling the
+ * rendering, if all the pixel buffers are still being read back, or the
+ * encoder is behind.
+ *
+ * Needs OpenGL 3.2 (or the ARB_sync and ARB_map_buffer_range extensions).
+ * E.g. see GUI::startCapture().
+ */
+class FrameCapture
+{
+public:
+    enum class Format
+    {
+        PNG, // `path` is the prefix of the files (e.g. "rec/frame-" -> "rec/frame-000001.png")
+        Y4M, // `path` is the file (e.g. "session.y4m"); the frame size must not change then
+    };
+
+    struct Stats
+    {
+        size_t captured = 0; // Frames read back
+        size_t written = 0;  // Frames encoded (not counting the repeated Y4M ones)
+        size_t dropped = 0;  // Frames lost (readback or encoder too slow, or a Y4M frame of a different size)
+        sf::Time overhead;   // Time spent in capture(), i.e. added to the rendering
+        sf::Time encoding;   // Time spent encoding (on the worker thread)
+    };
+
+    /**
+     * Check ok() for errors (already reported to cerr)
+     */
+    FrameCapture(const std::string& path, Format format, unsigned fps = 30);
+    ~FrameCapture(); // (Calls finish().)
+
+    bool ok() const { return m_ok; }
+
+    /**
+     * Stop, and encode the frames already captured (may block for that)
+     * (The stats are final after this.)
+     */
+    void finish();
+
+    /**
+     * Queue the readback of `target` (its GL context must be active, on the
+     * calling thread; e.g. right before display())
+     * The same thread must make all the calls to capture().
+     */
+    void capture(sf::RenderTarget& target);
+
+    Stats stats() const;
+
+private:
+    struct Functions; // The GL entry points (loaded via SFML, so nothing needs linking)
+
+    // A readback in flight
+    struct Slot
+    {
+        unsigned pbo = 0;
+        size_t capacity = 0; // bytes
+        void* fence = nullptr;
+        sf::Vector2u size;
+        bool flipped = false; // Bottom-up rows (as read from a window)
+        long long number = 0; // Time since the start, in frames (at `fps`)
+    };
+
+    // A frame handed to the encoder
+    struct Frame
+    {
+        std::vector<std::uint8_t> pixels; // RGBA, top-down
+        sf::Vector2u size;
+        long long number = 0;
+    };
+
+    bool initGL();
+    void collect(bool wait); // Hand the finished readbacks to the encoder
+    void encoder();          // The loop of the worker thread
+    bool encode(Frame& frame);
+    bool writeY4M(const Frame& frame);
+
+    std::string m_path;
+    Format m_format;
+    unsigned m_fps;
+    bool m_ok = false;
+
+    // GL side (only used by the capturing thread)
+    std::unique_ptr<Functions> m_gl;
+    bool m_glReady = false, m_glFailed = false;
+    static constexpr unsigned SLOTS = 3;
+    Slot m_slots[SLOTS];
+    unsigned m_next = 0;    // The slot to capture to next
+    unsigned m_pending = 0; // Slots in flight (the oldest at m_next - m_pending)
+    sf::Clock m_clock;      // Since the start
+    long long m_lastNumber = -1;
+
+    // Encoder side
+    static constexpr unsigned QUEUE = 4;
+    std::vector<std::unique_ptr<Frame>> m_free; // Pooled
+    std::deque<std::unique_ptr<Frame>> m_queue;
+    std::thread m_worker;
+    mutable std::mutex m_mutex; // For the queue, the pool, and m_stats
+    std::condition_variable m_wake;
+    bool m_stop = false;
+    Stats m_stats;
+    bool m_writeFailed = false; // (Reported only once.)
+
+    // Y4M stream
+    std::ofstream m_file;
+    sf::Vector2u m_streamSize;
+    long long m_streamFrames = 0;
+    std::vector<std::uint8_t> m_yuv; // The last frame written (for the repeats)
+};
+
+} // namespace gfx
+} // namespace sfw
+
+#endif // SFW_FRAMECAPTURE_HPP
@@ -0,0 +1,111 @@
+#ifndef SFW_OFFSCREENCACHE_HPP
+#define SFW_OFFSCREENCACHE_HPP
+
+#include "sfw/Gfx/Render.hpp"
+
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/Graphics/RenderStates.hpp>
+#include <SFML/System/Vector2.hpp>
+
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+namespace sfw
+{
+namespace gfx
+{
+
+//============================================================================
+/**
+ * Offscreen rendering of some content (e.g. a subtree of widgets), pasted on
+ * the target on every draw, until it's invalidated
+ *
+ * The texture is in target pixels (i.e. scaled by the view of the target),
+ * so the cache stays as sharp as direct drawing, at any zoom level. Moving,
+ * or zooming, re-renders it.
+ *
+ * All the caches share one memory limit (see setMemoryLimit()): if a new
+ * texture wouldn't fit, the least recently drawn caches (those not drawn in
+ * the current frame, see nextFrame()) are dropped for it, or, if that's still
+ * not enough, the cache can't be used (see draw()).
+ *
+ * Used by Layout::setCaching() and DrawHost::setCaching().
+ */
+class OffscreenCache
+{
+public:
+    OffscreenCache();
+    ~OffscreenCache(); // (Gives the memory back.)
+    // (Moving doesn't take the texture along: the new owner renders its own.)
+    OffscreenCache(OffscreenCache&& other) noexcept;
+    OffscreenCache& operator=(OffscreenCache&& other) noexcept;
+
+    /**
+     * Draw the content to ctx (at `size`, with `states`), via the cache:
+     * `render(const RenderContext&)` draws the content (the same way it would
+     * be drawn directly), if the cache is not up-to-date
+     * Returns false if the cache can't be used (i.e. there's not enough
+     * memory for it), so the content should be drawn directly instead.
+     */
+    template <typename Render>
+    bool draw(const RenderContext& ctx, const sf::RenderStates& states, sf::Vector2f size, Render&& render) const
+    {
+        switch (prepare(ctx, states, size))
+        {
+        case State::Unusable: return false;
+        case State::Empty:    return true;
+        case State::Stale:
+            // (Valid from now on, as the content may also invalidate it
+            // (again) while being drawn, e.g. when animating.)
+            render(beginRender(states));
+            endRender();
+            break;
+        case State::Valid: break;
+        }
+        paste(ctx);
+        return true;
+    }
+
+    void invalidate() const { m_valid = false; }
+    bool valid() const { return m_texture && m_valid; }
+
+    // Drop the texture (e.g. when caching is turned off)
+    void release() const;
+
+    /**
+     * Max. memory (in bytes) the textures of all the caches combined may use
+     */
+    static void setMemoryLimit(size_t bytes);
+    static size_t getMemoryLimit();
+    static size_t getMemoryUsage();
+
+    /**
+     * Start a new frame (for the eviction: the caches drawn since then are
+     * in use, and not dropped for others)
+     */
+    static void nextFrame();
+
+private:
+    enum class State { Unusable, Empty, Stale, Valid };
+
+    State prepare(const RenderContext& ctx, const sf::RenderStates& states, sf::Vector2f size) const;
+    RenderContext beginRender(const sf::RenderStates& states) const;
+    void endRender() const;
+    void paste(const RenderContext& ctx) const;
+
+    // Reserve `bytes` for this cache (dropping others, if needed)
+    bool allocate(size_t bytes) const;
+
+    struct Texture; // The render texture + a renderer for it
+    mutable std::unique_ptr<Texture> m_texture;
+    mutable size_t m_bytes = 0;
+    mutable sf::FloatRect m_area; // Where it's rendered for (in the world of the target)
+    mutable bool m_valid = false;
+    mutable std::uint64_t m_lastUse = 0; // Frame (see nextFrame())
+};
+
+} // namespace gfx
+} // namespace sfw
+
+#endif // SFW_OFFSCREENCACHE_HPP
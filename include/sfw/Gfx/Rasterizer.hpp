@@ -0,0 +1,117 @@
+#ifndef SFW_RASTERIZER_HPP
+#define SFW_RASTERIZER_HPP
+
+#include "sfw/Gfx/Render.hpp"
+
+#include <SFML/Graphics/Image.hpp>
+#include <SFML/Graphics/Texture.hpp>
+#include <SFML/Graphics/Color.hpp>
+
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+
+namespace sfw
+{
+namespace gfx
+{
+
+//============================================================================
+/**
+ * Software renderer: draws into an RGBA pixel buffer in system memory
+ *
+ * The widgets are drawn the usual way (via a gfx::Renderer, into a DrawList),
+ * and the result is then rasterized on the CPU, with no GL context needed
+ * for that, and deterministic results (e.g. for thumbnails, or reference
+ * images for regression tests).
+ *
+ * Triangles are sampled at the pixel centers, with a top-left fill rule (so
+ * the shared edges of quads are not blended twice), and nearest-neighbor
+ * texture sampling. Blending is SIMD-accelerated (SSE2, where available).
+ * sf::BlendAlpha, sf::BlendNone and premultiplied alpha (One, OneMinusSrcAlpha)
+ * are supported; everything else is treated as sf::BlendAlpha. Lines, points
+ * and shaders (except the one of the SDF text) are ignored, and so are
+ * arbitrary sf::Drawables (as they're not recorded; see Renderer::draw()).
+ *
+ * Text is drawn from the SDF atlases of the fonts (see SdfFont), which are
+ * in system memory anyway: the distances are sampled bilinearly, and turned
+ * to coverage like the SDF shader does. (Set Theme::sdfText, so that the
+ * widgets measure the text the same way, too; see TextLayout.) Text of
+ * fonts with no SDF atlas is drawn from their glyph pages, like any other
+ * texture (see below).
+ *
+ * The other textures are read from system memory copies, too: the theme
+ * texture is known (see Theme::getTextureImage()), others can be added by
+ * setTextureImage(), and the rest are read back from the GPU (which needs a
+ * GL context for SFML, though; the geometry of what can't be read is
+ * skipped).
+ */
+class Rasterizer
+{
+public:
+    Rasterizer(sf::Vector2u size);
+
+    void clear(sf::Color color = sf::Color::Transparent);
+
+    /**
+     * Draw the object (typically a whole widget tree) over the current content
+     * (The view can be changed via target(), like with any render target.)
+     */
+    void render(const Drawable& object, const sf::RenderStates& states = sf::RenderStates::Default);
+
+    /**
+     * Rasterize a draw list (e.g. one built by another renderer) over the
+     * current content
+     */
+    void draw(const DrawList& list);
+
+    /**
+     * Use this image as the content of `texture`
+     * (The image must have the same size as the texture, and must stay alive
+     * while used.)
+     */
+    void setTextureImage(const sf::Texture& texture, const sf::Image& image);
+
+    sf::RenderTarget& target() { return m_target; }
+    sf::Vector2u getSize() const { return m_size; }
+    const std::uint8_t* getPixels() const { return (const std::uint8_t*)m_pixels.data(); } // RGBA, row by row
+    sf::Image toImage() const;
+
+    /**
+     * The blending of a span of RGBA pixels, with sf::BlendAlpha
+     * (Exposed for testing/benchmarking the SIMD path.)
+     */
+    static void blendSpan(std::uint32_t* dst, const std::uint32_t* src, size_t count);
+
+private:
+    struct Vertex { float x, y; sf::Color color; float u, v; };
+    enum class Blend { Alpha, Premultiplied, None };
+
+    // The texels a command samples
+    struct Source
+    {
+        const std::uint8_t* texels = nullptr; // RGBA; nullptr if untextured
+        int width = 0, height = 0;
+        bool sdf = false; // A distance field (in alpha), to be turned to coverage
+    };
+
+    const sf::Image* imageOf(const sf::Texture* texture);
+    void fillTriangle(Vertex a, Vertex b, Vertex c, const Source& source, const sf::IntRect& clip, Blend blend);
+    void blend(std::uint32_t* dst, const std::uint32_t* src, size_t count, Blend mode);
+
+    sf::Vector2u m_size;
+    std::vector<std::uint32_t> m_pixels;
+    std::vector<std::uint32_t> m_span; // Scratch buffer for the source pixels of a row
+
+    NullTarget m_target;
+    Renderer m_renderer;
+
+    std::unordered_map<const sf::Texture*, const sf::Image*> m_textureImages; // Set by the user
+    std::unordered_map<const sf::Texture*, sf::Image> m_readback; // Read from the GPU (per render)
+};
+
+} // namespace gfx
+} // namespace sfw
+
+#endif // SFW_RASTERIZER_HPP
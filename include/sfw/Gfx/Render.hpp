@@ -44,7 +44,13 @@ public:
 //----------------------------------------------------------------------------
 //!!c++23 needed for this revolutionary feature:
 //!!#warning Unknown graphics backend! Umm... well, only SFML is supported, so selecting that...
+#if defined(SFW_HEADLESS) // (E.g. `make HEADLESS=1`)
+#include "sfw/cfg/USE_NULL"
+#elif defined(SFW_OPENGL) // (E.g. `make OPENGL=1`)
+#include "sfw/cfg/USE_OPENGL"
+#else
 #include "sfw/cfg/USE_SFML"
+#endif
 
 #ifdef SFW_CFG_GFX_USE_SFML
 #include "Render_sfml.hpp"
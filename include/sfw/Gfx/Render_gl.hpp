@@ -0,0 +1,116 @@
+#ifndef SFW_RENDER_GL_HPP
+#define SFW_RENDER_GL_HPP
+
+#include "sfw/Gfx/Render.hpp"
+
+#include <SFML/Graphics/RenderTarget.hpp>
+#include <SFML/System/Vector2.hpp>
+
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace sfw
+{
+namespace gfx
+{
+
+//============================================================================
+/**
+ * Native OpenGL submission for the renderer (see sfw/cfg/USE_OPENGL)
+ *
+ * Draws the commands of a DrawList with its own (GLSL 3.30) shader and
+ * streaming vertex buffer, instead of SFML's per-draw state setup: the
+ * vertices of a whole run of commands are uploaded at once (to a persistently
+ * mapped ring buffer, if ARB_buffer_storage is available, or by orphaning
+ * the buffer otherwise), and then each command costs a single glDrawArrays,
+ * plus a texture bind or a scissor change, only if it's different from the
+ * previous command's. SFML is only used for getting the GL context (and the
+ * function pointers) of the target.
+ *
+ * Commands it can't draw exactly like SFML would (with a shader, a blend mode
+ * other than sf::BlendAlpha, or a transform not baked into the vertices) are
+ * left to SFML (see submit()).
+ *
+ * There's only one of it per process (see shared()): the program and the
+ * vertex buffer are shared by all the GL contexts of SFML, so all the
+ * renderers (incl. those of the offscreen caches) use the same ones. Only
+ * the vertex array objects are per context (as GL doesn't share those).
+ *
+ * NOTE: SFML stores the textures of sf::RenderTextures upside down (which
+ *       it compensates for internally), so drawing such a texture natively
+ *       would show it flipped. (The layout caches are pasted with a custom
+ *       blend mode, so they're drawn by SFML anyway.)
+ */
+class GLBackend
+{
+public:
+    /**
+     * The backend of the process, created on the first call (which needs a
+     * GL context to be active!), and kept while any renderer is using it
+     */
+    static std::shared_ptr<GLBackend> shared();
+
+    ~GLBackend();
+
+    // False if the context can't do what we need (e.g. it's older than GL 3.3)
+    bool ready() const { return m_program != 0; }
+
+    /**
+     * Draw the commands of `list` from `from` on, up to the first one that it
+     * can't (or the end of the list). Returns the index of where it stopped.
+     * The GL state is left for SFML to continue with (see sf::RenderTarget::
+     * resetGLStates()).
+     */
+    size_t submit(sf::RenderTarget& target, const DrawList& list, size_t from, Renderer::Stats& stats);
+
+    static bool canDraw(const DrawList::Command& cmd);
+
+private:
+    struct Functions; // The GL entry points (loaded via SFML, so nothing needs linking)
+
+    GLBackend(); // See shared()
+
+    bool init();
+    void bindVertexArray(); // The one of the current context (made on its first use)
+    void grow(size_t bytes); // Make sure that `bytes` can be uploaded at once
+    int  upload(const void* vertices, size_t bytes); // Returns the index of the first vertex in the buffer
+
+    std::unique_ptr<Functions> m_gl;
+    unsigned m_program = 0;
+    int m_uProjection = -1, m_uTexScale = -1, m_uTextured = -1;
+
+    // The vertex buffer: either a persistently mapped ring of REGIONS regions
+    // (each guarded by a fence, so it's only overwritten when the GPU is done
+    // with it), or a plain buffer, orphaned for each upload
+    static constexpr unsigned REGIONS = 3;
+    unsigned m_vbo = 0;
+    unsigned m_buffer = 0; // Incremented for each new one (as GL may reuse the names)
+    bool m_persistent = false;
+    void* m_mapped = nullptr;
+    size_t m_regionSize = 0; // Or the whole buffer, when not persistent
+    unsigned m_region = 0;
+    void* m_fences[REGIONS] = {};
+
+    // The VAO of each context submitted to (with the buffer it's set up for)
+    // (Those of the contexts gone by now are just left as they are: their
+    // VAOs are gone with them, and the context IDs are never reused.)
+    struct VertexArray
+    {
+        std::uint64_t context;
+        unsigned vao;
+        unsigned buffer; // See m_buffer
+    };
+    std::vector<VertexArray> m_vertexArrays;
+
+    // Uniforms are kept by the program, so these stay valid across submissions
+    float m_projection[16] = {};
+    sf::Vector2u m_texSize;
+    bool m_textured = false;
+};
+
+} // namespace gfx
+} // namespace sfw
+
+#endif // SFW_RENDER_GL_HPP
@@ -4,6 +4,18 @@
 #include <SFML/Graphics/Drawable.hpp>
 #include <SFML/Graphics/RenderTarget.hpp>
 #include <SFML/Graphics/RenderStates.hpp>
+#include <SFML/Graphics/Vertex.hpp>
+#include <SFML/Graphics/PrimitiveType.hpp>
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/Graphics/Color.hpp>
+#include <SFML/Graphics/Text.hpp>
+#include <SFML/Graphics/Sprite.hpp>
+#include <SFML/Graphics/View.hpp>
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <cstddef>
 
 namespace sfw
 {
@@ -14,6 +26,9 @@ struct SFML //!!extend into some proper backend representation later
 {
 };
 
+class Renderer;
+class GLBackend;
+
 
 //----------------------------------------------------------------------------
 template <>
@@ -21,6 +36,11 @@ struct RenderContext_base<SFML>
 {
     sf::RenderTarget& target;
     const sf::RenderStates& props;
+    Renderer& renderer;
+
+    // Clipping for containers and widgets (see Renderer::pushClip())
+    void pushClip(const sf::FloatRect& rect, const sf::RenderStates& states) const;
+    void popClip() const;
 };
 
 using RenderContext = RenderContext_base<SFML>;
@@ -36,6 +56,7 @@ class Drawable : public Drawable_base<SFML>, public sf::Drawable
 //       So, implementing the sf::Drawable interface would do *NOTHING* for SFW!
 {
 friend class Layout;
+friend class Renderer;
 protected:
     void draw([[maybe_unused]] sf::RenderTarget& target,
               [[maybe_unused]] const sf::RenderStates& states) const override {} // It's optional now...
@@ -47,13 +68,382 @@ protected:
 
 
 //============================================================================
+/**
+ * Frame command buffer
+ *
+ * What the renderer has built from the draw() calls of a frame, in submission
+ * order: ranges of (pre-transformed) vertices, each with its render states
+ * and clip rect, all self-contained (apart from the textures and shaders, of
+ * course), so it can also be submitted (again) later: e.g. replayed for
+ * profiling, or compared to the previous frame (see Renderer).
+ */
+class DrawList
+{
+public:
+    struct Command
+    {
+        sf::PrimitiveType type = sf::PrimitiveType::Triangles;
+        size_t first = 0, count = 0; // Range in vertices()
+        sf::RenderStates states;
+        sf::IntRect clip; // In target pixels
+    };
+
+    sf::View view; // The view it has been built for (the clips are relative to that)
+
+    void clear() { m_commands.clear(); m_vertices.clear(); }
+    void add(const sf::Vertex* vertices, size_t count, sf::PrimitiveType type,
+             const sf::RenderStates& states, const sf::IntRect& clip);
+
+    bool empty() const { return m_commands.empty(); }
+    const std::vector<Command>& commands() const { return m_commands; }
+    const std::vector<sf::Vertex>& vertices() const { return m_vertices; }
+
+    /**
+     * Would submitting this one draw exactly the same as the other one?
+     * (Can't tell if the content of a texture has changed, and a list with
+     * a shader is never the same as anything, as its uniforms may change.)
+     */
+    bool sameAs(const DrawList& other) const;
+
+private:
+    std::vector<Command> m_commands;
+    std::vector<sf::Vertex> m_vertices;
+};
+
+
+//============================================================================
+/**
+ * Batching renderer
+ *
+ * Collects the (triangle-based) geometry of a frame into per-texture vertex
+ * streams, pre-transformed on the CPU, so that everything drawn with the same
+ * texture can be sent to the GPU with one draw call.
+ *
+ * Draws with different textures are reordered (i.e. merged into an earlier
+ * batch of the same texture) only if that doesn't change the result: i.e.
+ * nothing drawn since then with another texture overlaps them. This is
+ * tracked on a coarse grid over the view, so e.g. a form of N labeled boxes
+ * ends up as two draw calls: one for the boxes, one for the glyphs.
+ *
+ * The batches are built into a command buffer (see DrawList), which is only
+ * submitted to the target at the end of the frame (or before drawing an
+ * arbitrary sf::Drawable, which is then drawn directly, to keep the order
+ * intact). Optionally, the submission is skipped altogether, if the frame
+ * has turned out the same as the previous one (see setSkipUnchanged()).
+ *
+ * The current clip rect (see pushClip()) is also part of the batch key, so
+ * clipped widgets (e.g. a column of TextBoxes) can still be batched together.
+ *
+ * Untextured geometry is mapped to the solid texel of the theme texture, so
+ * it can go into the same batch as the theme-textured shapes.
+ *
+ * With the headless backend (see sfw/cfg/USE_NULL), everything goes through
+ * the same way, except the final submissions to the target, which are only
+ * counted (see Stats), so it can run e.g. on a NullTarget.
+ *
+ * With the OpenGL backend (see sfw/cfg/USE_OPENGL), the draw lists are
+ * submitted natively, bypassing SFML (see GLBackend).
+ */
 class Renderer : public Renderer_base<SFML>
 {
 public:
-    void render(const Drawable& object, const RenderContext& ctx);
+    struct Stats
+    {
+        size_t drawCalls = 0;       // Submissions to the target (batches + direct draws)
+        size_t vertices = 0;        // All the vertices submitted (except the ones of opaque sf::Drawables)
+        size_t primitives = 0;      // Triangles, lines or points, from the vertices above
+        size_t batchedVertices = 0; // Vertices sent via batches
+        size_t textureSwitches = 0; // Submissions with a different texture than the previous one
+        size_t clipChanges = 0;     // View switches for clipping
+        bool   skipped = false;     // The frame was the same as the previous one (see setSkipUnchanged())
+
+        void count(const DrawList::Command& cmd); // Add a submitted command
+    };
+
+#ifdef SFW_CFG_GFX_USE_NULL
+    static constexpr bool headless = true;
+#else
+    static constexpr bool headless = false;
+#endif
+
+    Renderer(sf::RenderTarget& target);
+    ~Renderer();
+
+    /**
+     * Draw the object (typically a whole widget tree) as one frame
+     */
+    void render(const Drawable& object, const sf::RenderStates& states = sf::RenderStates::Default);
+
+    /**
+     * Frame bracketing for drawing without render()
+     * end() submits the frame (see flush()).
+     */
+    void begin();
+    void end();
+
+    /**
+     * Don't submit a frame if it's exactly the same as the previous one
+     * (i.e. if it would draw the same pixels again; see DrawList::sameAs())
+     * Only useful for targets retaining their content across frames, of
+     * course (like a render texture, which is not cleared for each frame).
+     * Note: frames having drawn some sf::Drawable directly never count as
+     * unchanged (see draw()).
+     */
+    void setSkipUnchanged(bool skip) { m_skipUnchanged = skip; }
+
+    /**
+     * Only build the draw lists, never submit them (e.g. for drawing them
+     * by other means, like gfx::Rasterizer)
+     * (Direct draws of arbitrary sf::Drawables are then dropped.)
+     */
+    void setRecordOnly(bool recordOnly) { m_recordOnly = recordOnly; }
+
+    /**
+     * How to draw text: as Theme::sdfText says (Auto), always via the glyph
+     * pages of the fonts (Plain), or always from the SDF atlases of the fonts
+     * that have one (Sdf; e.g. for consumers of the draw lists that can't read
+     * back the glyph pages, like gfx::Rasterizer; see SdfFont)
+     */
+    enum class TextMode { Auto, Plain, Sdf };
+    void setTextMode(TextMode mode) { m_textMode = mode; }
+
+    /**
+     * Does the drawing end up on the target? (Not with the headless backend,
+     * or when only recording.) E.g. no point in offscreen caching otherwise.
+     */
+    bool submitting() const { return !headless && !m_recordOnly; }
+
+    /**
+     * The command buffer of the current (or, after end(), the last) frame
+     */
+    const DrawList& drawList() const { return m_drawList; }
+
+    /**
+     * Submit the commands of a draw list (from `from` on) to the target
+     * (Normally done by flush() and end(), but e.g. a frame can also be
+     * replayed this way, for profiling.)
+     */
+    void submit(const DrawList& list, size_t from = 0);
+
+    /**
+     * Add the commands of a draw list (e.g. built by another renderer, with
+     * the same view) to the current frame, after everything drawn so far
+     */
+    void append(const DrawList& list);
+
+    /**
+     * Lock to hold while using fonts (e.g. sf::Text::findCharacterPos()), if
+     * the fonts may be shared with renderers on other threads: SFML loads
+     * the glyphs on demand, so even a const sf::Font is not thread-safe.
+     * draw(sf::Text) takes it itself. Without one set, lockFonts() returns
+     * an empty (no-op) lock.
+     * (E.g. see GUI::setParallelBuild().)
+     */
+    void setFontLock(std::mutex* lock) { m_fontLock = lock; }
+    std::unique_lock<std::mutex> lockFonts() const
+        { return m_fontLock ? std::unique_lock(*m_fontLock) : std::unique_lock<std::mutex>(); }
+
+    /**
+     * Vertices (in the local coordinate system of `states.transform`) to be
+     * batched. Triangle-based primitives (incl. strips and fans) go to the
+     * batch, anything else (or anything with a shader or custom blend mode)
+     * is drawn directly.
+     */
+    void draw(const sf::Vertex* vertices, size_t vertexCount, sf::PrimitiveType type,
+              const sf::RenderStates& states);
+
+    /**
+     * Text is batched per font page (glyph texture)
+     * With Theme::sdfText set, the glyphs come from the distance-field atlas
+     * of the font instead (see SdfFont), laid out by TextLayout (as the
+     * widgets measure it), and drawn with its shader (batched together as
+     * well).
+     * (Outlined text is drawn directly by SFML.)
+     */
+    void draw(const sf::Text& text, const sf::RenderStates& states);
+
+    /**
+     * Sprites are batched with the rest of the geometry of their texture
+     */
+    void draw(const sf::Sprite& sprite, const sf::RenderStates& states);
+
+    /**
+     * Objects that can feed their own geometry to the renderer
+     * (i.e. the Box, Arrow etc. shapes)
+     */
+    template <class T> requires requires (const T& obj, Renderer& r, const sf::RenderStates& s) { obj.draw(r, s); }
+    void draw(const T& object, const sf::RenderStates& states) { object.draw(*this, states); }
+
+    /**
+     * Anything else is drawn directly by SFML (after flushing the frame so
+     * far; see flush())
+     * (The object is not recorded in the draw list, as it can't be copied.)
+     */
+    void draw(const sf::Drawable& object, const sf::RenderStates& states = sf::RenderStates::Default);
+
+    /**
+     * Solid (untextured) rectangle, batched
+     */
+    void fillRect(const sf::FloatRect& rect, sf::Color color, const sf::RenderStates& states);
+
+    /**
+     * 9-slice rectangle (e.g. a Box), batched
+     *
+     * `rect` is cut into a 3x3 grid, with `border` wide edges, each cell
+     * textured with the matching cell of the `border` x `border` grid of
+     * `texture` at `texPos` (the corners and edges as is, the middle
+     * stretched). The geometry is generated right into the batch, so the
+     * shapes only need to keep their rect (and texture position) for it.
+     */
+    void drawNineSlice(const sf::FloatRect& rect, float border, sf::Vector2f texPos,
+                       const sf::Texture& texture, const sf::RenderStates& states);
+
+    /**
+     * The same geometry, as sf::PrimitiveType::Triangles, written to `out`
+     * (with room for NINE_SLICE_VERTICES); returns the vertex count (empty
+     * cells are skipped)
+     * (E.g. for drawing it directly to an SFML target.)
+     */
+    static constexpr size_t NINE_SLICE_VERTICES = 9 * 6;
+    static size_t nineSlice(sf::Vertex* out, const sf::FloatRect& rect, float border, sf::Vector2f texPos,
+                            const sf::Transform& transform = sf::Transform::Identity);
+
+    /**
+     * Clipping
+     *
+     * Restrict the drawing to `rect` (in the local coordinate system of
+     * `transform`), intersected with the current clip area, until the
+     * matching popClip(). (Only valid within a frame, see begin()/end().)
+     *
+     * The clip area is kept in target pixels (a rotated rect is clipped to
+     * its bounding box), and is applied to the target (as a view restricted
+     * to it) only when something is actually submitted with a different clip
+     * than the previous submission. So there's no GL state to manage, and it
+     * works the same way with any view or render texture.
+     *
+     * Everything drawn with an empty clip area is just dropped.
+     */
+    void pushClip(const sf::FloatRect& rect, const sf::Transform& transform = sf::Transform::Identity);
+    void popClip();
+    const sf::IntRect& clip() const { return m_clipStack.empty() ? m_baseClip : m_clipStack.back(); }
+
+    /**
+     * The current clip area, in the local coordinate system of `transform`
+     * (its bounding box, if rotated), for culling: nothing outside it would
+     * be visible (e.g. see Layout::draw())
+     */
+    sf::FloatRect clipArea(const sf::Transform& transform = sf::Transform::Identity) const;
+
+    /**
+     * A view mapping the world the same way as `view`, but only to the
+     * `pixels` part of a target of `targetSize`
+     */
+    static sf::View clipView(const sf::View& view, const sf::IntRect& pixels, sf::Vector2u targetSize);
+
+    /**
+     * Submit everything drawn so far (in the current frame) to the target
+     * Must be called before drawing anything to the target by other means!
+     */
+    void flush();
+
+    sf::RenderTarget& target() const { return m_target; }
+    const Stats& stats() const { return m_stats; }
+
+private:
+    struct Batch
+    {
+        const sf::Texture* texture = nullptr;
+        const sf::Shader* shader = nullptr; // (Only SdfFont's.)
+        sf::IntRect clip;
+        std::vector<sf::Vertex> vertices; // sf::PrimitiveType::Triangles
+    };
+
+    // The geometry of a single draw() call is collected to m_chunk first,
+    // then moved to a suitable batch by commitChunk():
+    void appendTriangle(const sf::Vertex& v0, const sf::Vertex& v1, const sf::Vertex& v2,
+                        const sf::Transform& transform, bool solid);
+    void commitChunk(const sf::Texture* texture, const sf::Shader* shader = nullptr);
+    void resetGrid();
+    void closeBatches(); // Move the batches to the draw list
+    // All the drawing to the target goes through these (to keep the stats, and
+    // for the headless mode to stop right there):
+    void submit(const DrawList& list, const DrawList::Command& cmd);
+    void submit(const sf::Drawable& object, const sf::RenderStates& states);
+    void ensureFrame() { if (m_grid.empty()) begin(); } // In case not even begin() was called...
+    bool clippedOut() const { return clip().width <= 0 || clip().height <= 0; }
+
+    sf::RenderTarget& m_target;
+
+    std::vector<Batch> m_batches; // Pooled: only the first m_batchCount are in use
+    size_t m_batchCount = 0;
+    std::vector<sf::Vertex> m_chunk;
+
+    // Coarse occupancy grid over the view: the (1-based) index of the last
+    // batch drawing to each cell, or 0 if none
+    static constexpr float GRID_CELL_SIZE = 32;
+    std::vector<size_t> m_grid;
+    size_t m_gridWidth = 0, m_gridHeight = 0;
+    sf::FloatRect m_gridArea;
+
+    // The view of the target at begin(), and its viewport (in pixels) as the
+    // outermost clip rect
+    sf::View m_baseView;
+    sf::IntRect m_baseClip;
+    std::vector<sf::IntRect> m_clipStack;
+    const sf::Texture* m_lastTexture = nullptr; // Of the last submission (for the stats)
+
+    // The command buffers of the current and the previous frame (pooled)
+    DrawList m_drawList;
+    DrawList m_prevDrawList;
+    size_t m_submitted = 0; // Commands of m_drawList submitted so far
+    bool m_skipUnchanged = false;
+    bool m_recordOnly = false;
+    TextMode m_textMode = TextMode::Auto;
+    std::mutex* m_fontLock = nullptr;
+
+#ifdef SFW_CFG_GFX_USE_OPENGL
+    std::shared_ptr<GLBackend> m_gl; // Acquired at the first submission (needs the GL context)
+#endif
+
+    Stats m_stats;
 };
 
 
+//----------------------------------------------------------------------------
+/**
+ * Render target with nothing behind it
+ *
+ * It has a size and a view (for the renderer to map, clip, cull etc. with),
+ * but no pixels, and no GL context; nothing is ever drawn to it (SFML skips
+ * drawing to targets that can't be activated), so it can be used with any
+ * backend. (E.g. see the headless one, or gfx::Rasterizer.)
+ */
+class NullTarget : public sf::RenderTarget
+{
+public:
+    NullTarget(sf::Vector2u size) : m_size(size) { initialize(); }
+
+    sf::Vector2u getSize() const override { return m_size; }
+    void setSize(sf::Vector2u size) { m_size = size; } // (The view is not reset.)
+    bool setActive([[maybe_unused]] bool active = true) override { return false; }
+
+private:
+    sf::Vector2u m_size;
+};
+
+
+//----------------------------------------------------------------------------
+inline void RenderContext::pushClip(const sf::FloatRect& rect, const sf::RenderStates& states) const
+{
+    renderer.pushClip(rect, states.transform);
+}
+
+inline void RenderContext::popClip() const
+{
+    renderer.popClip();
+}
+
+
 } // namespace gfx
 } // namespace sfw
 #endif // SFW_RENDER_SFML_HPP
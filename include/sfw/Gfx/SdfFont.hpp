@@ -0,0 +1,164 @@
+#ifndef SFW_SDFFONT_HPP
+#define SFW_SDFFONT_HPP
+
+#include <SFML/Graphics/Font.hpp>
+#include <SFML/Graphics/Texture.hpp>
+#include <SFML/Graphics/Shader.hpp>
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/String.hpp>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+
+struct FT_LibraryRec_;
+struct FT_FaceRec_;
+
+namespace sfw
+{
+namespace gfx
+{
+
+//============================================================================
+/**
+ * Signed-distance-field glyph atlas of a font
+ *
+ * The glyphs are rasterized only once, at BASE_SIZE, and stored as distance
+ * fields (the distance from the outline, in the alpha channel; 0.5 is the
+ * edge), which can be drawn at any size, or scale, and stay crisp, when drawn
+ * with shader() (which finds the edge per pixel). So e.g. zooming, or changing
+ * the text size, doesn't need rasterizing new glyphs.
+ *
+ * It has its own FreeType face of the font file (see load()), so the glyphs
+ * are made on the CPU, without going through (and reading back) the glyph
+ * pages of SFML, and all the metrics (advances, kerning, line spacing etc.)
+ * come from the same (unhinted) outlines, in BASE_SIZE units, to be scaled to
+ * the actual size. (Text drawn this way must be measured this way, too; see
+ * TextLayout.)
+ *
+ * Glyphs are added to the atlas on demand. The atlas is kept in system memory
+ * (see getPixels()), and only the changed rows are uploaded to the texture,
+ * when it's next used (see getTexture()).
+ *
+ * The renderer uses this for sf::Text, if Theme::sdfText is set (see forText(),
+ * and Renderer::draw(const sf::Text&)).
+ *
+ * Optional: needs FreeType, so it's only built in with SFW_SDF_TEXT defined
+ * (e.g. `make SDF=1`); otherwise there are no atlases (load() returns nullptr),
+ * and all text is plain sf::Text (also measured that way).
+ *
+ * NOTE: Not thread-safe (just like sf::Font); see Renderer::setFontLock().
+ */
+class SdfFont
+{
+public:
+    static constexpr unsigned BASE_SIZE = 48; // Pixel size of the glyphs in the atlas
+    static constexpr unsigned SPREAD = 6;     // Range of the distances around the outline (in pixels, at BASE_SIZE)
+#ifdef SFW_SDF_TEXT
+    static constexpr bool available = true;   // Built with FreeType
+#else
+    static constexpr bool available = false;
+#endif
+
+    struct Glyph
+    {
+        float advance = 0;
+        sf::FloatRect bounds;      // Of the outline, relative to the baseline (like sf::Glyph::bounds)
+        sf::FloatRect quadBounds;  // The same, including the SPREAD margins (i.e. of the distance field)
+        sf::FloatRect textureRect; // In the atlas
+    };
+
+    /**
+     * Make the SDF atlas of `font`, from the file it was loaded from
+     * (Replaces the previous one, if any. Returns nullptr, if the file is not
+     * a scalable font, so it can't be used this way.)
+     */
+    static SdfFont* load(const sf::Font& font, const std::string& filename);
+
+    /**
+     * The SDF atlas of `font` (see load()), or nullptr
+     */
+    static SdfFont* of(const sf::Font& font);
+
+    /**
+     * The SDF atlas to draw (and measure) text of `font` with, or nullptr, if
+     * it should be plain text (Theme::sdfText is not set, or there's no atlas
+     * for the font, or no shader to draw it with)
+     */
+    static SdfFont* forText(const sf::Font& font);
+
+    /**
+     * The SDF atlas having `texture` (i.e. for telling SDF text apart in a
+     * draw list), or nullptr
+     */
+    static SdfFont* ofTexture(const sf::Texture* texture);
+
+    /**
+     * Drop the atlas of `font` (e.g. when the font is reloaded, or destroyed)
+     */
+    static void forget(const sf::Font& font);
+
+    /**
+     * The shader to draw the glyphs (of any SdfFont) with
+     * (Uses the texture of the draw call, and its vertex colors.)
+     */
+    static const sf::Shader* shader();
+
+    ~SdfFont();
+
+    const Glyph& getGlyph(std::uint32_t codePoint, bool bold);
+
+    // Metrics (in BASE_SIZE pixels)
+    float getKerning(std::uint32_t first, std::uint32_t second) const;
+    float getLineSpacing() const { return m_lineSpacing; }
+    float getUnderlinePosition() const { return m_underlinePosition; }
+    float getUnderlineThickness() const { return m_underlineThickness; }
+
+    /**
+     * The atlas texture, updated with the glyphs added since the last call
+     * (Not created with the headless backend.)
+     */
+    const sf::Texture& getTexture();
+
+    // The atlas in system memory (RGBA, the distances in alpha)
+    const std::vector<std::uint8_t>& getPixels() const { return m_pixels; }
+    sf::Vector2u getSize() const { return m_size; }
+
+    /**
+     * Texture coords. of a texel deep inside (for the solid lines, like
+     * underlining)
+     */
+    sf::Vector2f getSolidTexel() const { return {1.5f, 1.5f}; }
+
+private:
+    SdfFont();
+    SdfFont(const SdfFont&) = delete;
+    SdfFont& operator=(const SdfFont&) = delete;
+
+    bool open(const std::string& filename);
+    void render(std::uint32_t codePoint, bool bold, Glyph& glyph); // Rasterize, and add to the atlas
+    bool reserve(sf::Vector2u size, sf::Vector2u& position); // Find room in the atlas
+
+    static std::uint64_t key(std::uint32_t codePoint, bool bold) { return (std::uint64_t)codePoint << 1 | bold; }
+
+    FT_LibraryRec_* m_library = nullptr;
+    FT_FaceRec_* m_face = nullptr;
+    float m_unitScale = 0; // Font units -> BASE_SIZE pixels
+    float m_lineSpacing = 0, m_underlinePosition = 0, m_underlineThickness = 0;
+
+    std::unordered_map<std::uint64_t, Glyph> m_glyphs;
+
+    // The atlas, filled by shelves (the rows from m_dirtyTop to m_dirtyBottom
+    // are yet to be uploaded)
+    std::vector<std::uint8_t> m_pixels; // RGBA
+    sf::Vector2u m_size;
+    sf::Texture m_texture;
+    unsigned m_shelfTop = 0, m_shelfHeight = 0, m_penX = 0;
+    unsigned m_dirtyTop = 0, m_dirtyBottom = 0;
+};
+
+} // namespace gfx
+} // namespace sfw
+
+#endif // SFW_SDFFONT_HPP
@@ -0,0 +1,97 @@
+#ifndef SFW_TEXTLAYOUT_HPP
+#define SFW_TEXTLAYOUT_HPP
+
+#include "sfw/Gfx/SdfFont.hpp"
+
+#include <SFML/Graphics/Text.hpp>
+#include <SFML/Graphics/Font.hpp>
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Vector2.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace sfw
+{
+namespace gfx
+{
+
+//============================================================================
+/**
+ * Walks the characters of an sf::Text, placing them with the glyphs and
+ * metrics of an SdfFont (scaled to the character size), by the rules of
+ * sf::Text (kerning, letter and line spacing, tabs etc.)
+ *
+ * This is what both the renderer draws SDF text by (see Renderer::draw(const
+ * sf::Text&)), and the widgets measure text by (see textBounds() etc. below),
+ * so what's measured is what's drawn.
+ */
+class TextLayout
+{
+public:
+    /**
+     * The SDF atlas `text` is drawn with (see SdfFont::forText()), or nullptr
+     * for plain text (also for outlined text, which is left to SFML)
+     */
+    static SdfFont* fontOf(const sf::Text& text);
+
+    TextLayout(const sf::Text& text, SdfFont& font);
+
+    /**
+     * Step to the next character (false past the last one)
+     * ('\r's are skipped, as sf::Text does.)
+     */
+    bool next();
+
+    std::size_t index() const { return m_index; }
+    std::uint32_t character() const { return m_char; }
+
+    // Where the character goes (on the baseline, in the local coords. of the
+    // text); after the last one: where the next one would go
+    sf::Vector2f pen() const { return m_pen; }
+    // Where the one after it would go (without the kerning)
+    sf::Vector2f penAfter() const;
+
+    // The glyph of the character (nullptr for whitespace)
+    const SdfFont::Glyph* glyph() const { return m_glyph; }
+    // The glyph bounds (see SdfFont::Glyph), scaled to the character size
+    sf::FloatRect bounds() const;
+    sf::FloatRect quadBounds() const;
+
+    // A newline ending a non-empty line (i.e. one to underline)?
+    bool endsLine() const { return m_char == U'\n' && m_prev != U'\n'; }
+
+    float lineSpacing() const { return m_lineSpacing; }
+    float underlineOffset() const { return m_font.getUnderlinePosition() * m_scale; }
+    float underlineThickness() const { return m_font.getUnderlineThickness() * m_scale; }
+    float strikeThroughOffset() const { return m_strikeThroughOffset; }
+
+private:
+    const sf::String& m_string;
+    SdfFont& m_font;
+    bool m_bold;
+    float m_scale; // BASE_SIZE -> character size
+    float m_whitespaceWidth, m_letterSpacing, m_lineSpacing, m_strikeThroughOffset;
+
+    std::size_t m_index = (std::size_t)-1;
+    std::uint32_t m_char = 0, m_prev = 0;
+    sf::Vector2f m_pen;
+    float m_advance = 0;
+    const SdfFont::Glyph* m_glyph = nullptr;
+};
+
+/**
+ * Measuring text as the renderer draws it (i.e. with TextLayout for SDF text,
+ * or as sf::Text does it otherwise), for the widgets
+ */
+// Like sf::Text::getLocalBounds()
+sf::FloatRect textBounds(const sf::Text& text);
+// Like sf::Text::findCharacterPos()
+sf::Vector2f findCharacterPos(const sf::Text& text, std::size_t index);
+// Like sf::Font::getLineSpacing()
+float lineSpacing(const sf::Font& font, unsigned characterSize);
+
+} // namespace gfx
+} // namespace sfw
+
+#endif // SFW_TEXTLAYOUT_HPP
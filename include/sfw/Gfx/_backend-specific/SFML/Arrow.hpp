@@ -8,6 +8,7 @@
 
 namespace sfw
 {
+namespace gfx { class Renderer; }
 
 class Arrow: public sf::Drawable
 {
@@ -30,8 +31,10 @@ public:
 
     sf::Vector2f getSize() const;
 
+    void draw(gfx::Renderer& renderer, const sf::RenderStates& states) const;
+
 private:
-    void draw(sf::RenderTarget& target, const sf::RenderStates& states) const;
+    void draw(sf::RenderTarget& target, const sf::RenderStates& states) const override;
 
     void updateGeometry(float x, float y, Direction direction);
 
@@ -4,7 +4,6 @@
 #include "sfw/WidgetState.hpp"
 
 #include <SFML/Graphics/Drawable.hpp>
-#include <SFML/Graphics/Vertex.hpp>
 #include <SFML/System/Vector2.hpp>
 #include <SFML/Graphics/Color.hpp>
 #include <SFML/Graphics/Text.hpp>
@@ -14,9 +13,11 @@
 
 namespace sfw
 {
+namespace gfx { class Renderer; }
 
 /**
  * Utility class used by widgets for holding visual components
+ * (A textured 9-slice rectangle; see Theme::getTextureRect().)
  */
 class Box: public sf::Drawable
 {
@@ -78,59 +79,33 @@ public:
     void centerTextHorizontally(sf::Text& text);
     void centerVerticalTextVertically(sf::Text& text);
 
+    /**
+     * Feed the geometry to the (batching) renderer
+     */
+    void draw(gfx::Renderer& renderer, const sf::RenderStates& states) const;
+
 protected:
     void draw(sf::RenderTarget& target, const sf::RenderStates& states) const override;
 
+    /**
+     * Fill the inner (non-border) area with a color, directly to an SFML target
+     * (Without any temporary shapes, so it doesn't allocate.)
+     */
+    void fillInnerRect(sf::RenderTarget& target, sf::Color color, const sf::RenderStates& states) const;
+
     virtual void onPress() {};
     virtual void onRelease() {};
 
     Type m_type;
 
 private:
-
-    // A Box is drawn using a triangle strip (sf::TriangleStrip) that
-    // consists of 3 isomorphic rows (segments) of 9 vertices each:
-    // 8 to draw the (textured) rectangles, + 1 more for "carriage return",
-    // driving the triangle strip back to the left of the next segment,
-    // via 2 degenerate triangles (6-7-8, 7-8-9):
-    //
-    // 0 2 4 6                                  (6)
-    // |/|/|/|  ->  then 8 := 7  ->              |
-    // 1 3 5 7                       (1)-(3)-(5)-8
-    //
-    // Now 9 goes back to 1, and the process repeats with the 2nd row; etc.
-    // Note that the next segment will start by repeating this last vertex,
-    // resulting in yet another degenerate triangle.
-
-    static constexpr size_t VERTICES_PER_SEGMENT = 9;
-    static constexpr size_t VERTEX_COUNT = 3 * VERTICES_PER_SEGMENT;
-
-    enum StripSegment
-    {
-        TOP_SEGMENT,
-        MIDDLE_SEGMENT,
-        BOTTOM_SEGMENT,
-    };
-
-    enum Vertex
-    {
-        TOP_LEFT,
-        BOTTOM_RIGHT = VERTICES_PER_SEGMENT * 3 - 1,
-    };
-
-    /**
-     * Set the geometry for one line of the 9 slices
-     */
-    void setSegmentGeometry(StripSegment n, float x0, float x2, float x4, float x6, float top, float bottom);
-
-    /**
-     * Set the texture coords for one line of the 9 slices
-     */
-    void setSegmentTextureCoords(StripSegment n, float txleft, float txtop, float txwidth, float txheight);
-
-
+    // Only the rect and the state are kept: the 9-slice geometry is generated
+    // at draw time (see gfx::Renderer::drawNineSlice()), textured from the
+    // theme texture rect of the current type and state (shared by all the
+    // boxes), so e.g. a state change doesn't touch any vertices.
+    sf::Vector2f m_position;
+    sf::Vector2f m_size;
     WidgetState m_state;
-    sf::Vertex m_vertices[VERTEX_COUNT];
     std::optional<sf::Color> m_fillColor;
 };
 
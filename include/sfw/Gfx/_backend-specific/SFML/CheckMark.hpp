@@ -8,6 +8,7 @@
 
 namespace sfw
 {
+namespace gfx { class Renderer; }
 
 class CheckMark: public sf::Drawable
 {
@@ -21,8 +22,10 @@ public:
     sf::Vector2f getSize() const;
     void setColor(const sf::Color& color);
 
+    void draw(gfx::Renderer& renderer, const sf::RenderStates& states) const;
+
 private:
-    void draw(sf::RenderTarget& target, const sf::RenderStates& states) const;
+    void draw(sf::RenderTarget& target, const sf::RenderStates& states) const override;
 
     void updateGeometry(float x, float y);
 
@@ -31,6 +31,8 @@ public:
     inline T& item() { return m_item; }
     inline const T& item() const { return m_item; }
 
+    void draw(gfx::Renderer& renderer, const sf::RenderStates& states) const;
+
 private:
     void draw(sf::RenderTarget& target, const sf::RenderStates& states) const override;
     void onPress() override;
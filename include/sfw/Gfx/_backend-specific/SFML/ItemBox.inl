@@ -1,7 +1,7 @@
 #include "sfw/Theme.hpp"
+#include "sfw/Gfx/Render.hpp"
 
 #include <SFML/Graphics/RenderTarget.hpp>
-#include <SFML/Graphics/RectangleShape.hpp>
 
 namespace sfw
 {
@@ -74,12 +74,21 @@ void ItemBox<T>::draw(sf::RenderTarget& target, const sf::RenderStates& states)
     // "Tint" the boxes *after* the item has been drawn! (So, alpha is expected to have been set accordingly.)
     if (m_tintColor)
     {
-        sf::RectangleShape r(sf::Vector2f(getSize().x - 2 * (float)Theme::borderSize,
-                                          getSize().y - 2 * (float)Theme::borderSize));
-        r.setPosition(getPosition()); r.move({(float)Theme::borderSize, (float)Theme::borderSize});
-        r.setFillColor(m_tintColor.value());
-        r.setOutlineThickness(0);
-        target.draw(r, states);
+        fillInnerRect(target, m_tintColor.value(), states);
+    }
+}
+
+template <class T>
+void ItemBox<T>::draw(gfx::Renderer& renderer, const sf::RenderStates& states) const
+{
+    Box::draw(renderer, states);
+    renderer.draw(m_item, states);
+
+    // "Tint" the boxes *after* the item has been drawn! (So, alpha is expected to have been set accordingly.)
+    if (m_tintColor)
+    {
+        sf::Vector2f border((float)Theme::borderSize, (float)Theme::borderSize);
+        renderer.fillRect({getPosition() + border, getSize() - border * 2.f}, m_tintColor.value(), states);
     }
 }
 
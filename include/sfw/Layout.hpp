@@ -2,8 +2,14 @@
 #define GUI_LAYOUT_HPP
 
 #include "sfw/WidgetContainer.hpp"
+#include "sfw/Gfx/OffscreenCache.hpp"
+
+#include <SFML/Graphics/Rect.hpp>
 
 #include <functional>
+#include <vector>
+#include <cstddef>
+
 
 namespace sfw
 {
@@ -14,6 +20,58 @@ namespace sfw
  */
 class Layout: public WidgetContainer
 {
+public:
+    /**
+     * Render the layout (the entire subtree) into an offscreen texture, and
+     * then just paste that on every draw, until something changes in it
+     *
+     * Useful for large, mostly static panels, which would then cost a single
+     * draw call, instead of drawing all their widgets every time. (Note that
+     * any (even just a hover) change in the subtree will rebuild the cache.)
+     *
+     * If there's not enough of the (global) cache memory left (see
+     * setCacheMemoryLimit()), the layout will just be drawn normally.
+     * (The texture is in target pixels, so it's as sharp as the direct
+     * drawing; see gfx::OffscreenCache.)
+     */
+    Layout* setCaching(bool enable);
+    bool caching() const { return m_caching; }
+
+    /**
+     * Is there an up-to-date cached rendering of the layout?
+     */
+    bool isCacheValid() const;
+
+    /**
+     * Force rebuilding the cache (on the next draw)
+     * Normally not needed, as the children do invalidate it themselves,
+     * when they change (see Widget::invalidate()).
+     */
+    void invalidateCache() const { m_cache.invalidate(); }
+
+    /**
+     * Max. memory (in bytes) all the cache textures combined (incl. those of
+     * DrawHost) may use (see gfx::OffscreenCache: the least recently drawn
+     * caches are dropped for new ones)
+     */
+    static void setCacheMemoryLimit(size_t bytes) { gfx::OffscreenCache::setMemoryLimit(bytes); }
+    static size_t getCacheMemoryLimit() { return gfx::OffscreenCache::getMemoryLimit(); }
+    static size_t getCacheMemoryUsage() { return gfx::OffscreenCache::getMemoryUsage(); }
+
+    /**
+     * Clip the drawing of the children to the rect of the layout
+     * (E.g. for panels with content that may not fit, like scrolled ones.)
+     */
+    Layout* setClipping(bool enable);
+    bool clipping() const { return m_clipping; }
+
+    /**
+     * Rebuild the index for finding the child under the mouse, or the ones
+     * to draw (lazily, on the next mouse event, or draw)
+     * Normally not needed, as moving or resizing a child does this itself.
+     */
+    void invalidateHitIndex() const { m_hitIndex.valid = false; }
+
 protected:
     Layout();
 
@@ -40,9 +98,71 @@ protected:
     bool focusNextWidget();
     bool focusPreviousWidget();
 
+    /**
+     * Can any of `child` be in `visible` (both in the coordinates of the
+     * layout)? (Also if it has no size yet, as it may draw anywhere then.)
+     */
+    static bool mayBeVisible(const Widget* child, const sf::FloatRect& visible);
+
+    /**
+     * For the layouts arranging their children: apply the new size of the
+     * content (from recomputeGeometry())
+     * If the parent arranges this layout, it's only reported to it as the
+     * preferred size (the parent then arranges it, later, if needed), the
+     * current (arranged) size is kept. Otherwise it's the new size.
+     * Returns true if the layout has been resized (and so onResized() has
+     * arranged the children already), otherwise they still need arranging
+     * in the current size.
+     */
+    bool updateSize(const sf::Vector2f& contentSize);
+
 private:
+    void drawChildren(const gfx::RenderContext& ctx) const;
+
+    /**
+     * Draw via the offscreen cache (rebuilding it if needed)
+     * Returns false if the cache can't be used (i.e. there's no memory
+     * left for it), so the layout should be drawn directly instead.
+     */
+    bool drawCached(const gfx::RenderContext& ctx) const;
+
+    /**
+     * The (first) child containing `point` (in the coordinates of the layout),
+     * or nullptr
+     * The hovered child is tried first (so moving within the same widget
+     * doesn't need a search at all, on any level of the tree), then the
+     * index (see HitIndex).
+     */
+    Widget* childAt(const sf::Vector2f& point) const;
+    void buildHitIndex() const;
+
     Widget* m_hover;
     Widget* m_focus;
+    bool m_clipping = false;
+
+    // The children sorted along the axis they overlap the least on (i.e. the
+    // stacking axis for HBox/VBox, rows for grids etc.), so only those that
+    // start within the longest child's length before a point (or the visible
+    // area, when drawing) need checking
+    struct HitIndex
+    {
+        struct Entry
+        {
+            float start;
+            size_t order; // In the child list (the first one wins, if they overlap)
+            Widget* widget;
+        };
+        std::vector<Entry> entries;
+        bool vertical = false;
+        float maxLength = 0;
+        bool disjoint = true; // No two children overlap (so the hovered one can't be covered)
+        bool unsized = false; // Some children have no size, i.e. an unknown extent (see mayBeVisible())
+        bool valid = false;
+    };
+    mutable HitIndex m_hitIndex;
+
+    bool m_caching = false;
+    gfx::OffscreenCache m_cache;
 };
 
 } // namespace
@@ -0,0 +1,107 @@
+#ifndef GUI_CONSTRAINTLAYOUT_HPP
+#define GUI_CONSTRAINTLAYOUT_HPP
+
+#include "sfw/Layout.hpp"
+#include "sfw/util/cassowary.hpp"
+
+#include <SFML/System/Vector2.hpp>
+
+#include <unordered_map>
+#include <vector>
+
+namespace sfw
+{
+
+/**
+ * Layout of children placed by linear constraints between their edges
+ * (and the edges of the layout), e.g.:
+ *
+ *     auto layout = gui.add(new ConstraintLayout);
+ *     auto ok = layout->add(Button("OK")), cancel = layout->add(Button("Cancel"));
+ *     auto& a = layout->anchors(ok), & b = layout->anchors(cancel);
+ *     layout->addConstraint(b.left == a.right() + 10);
+ *     layout->addConstraint(b.top == a.top);
+ *
+ * The children keep their own sizes by default (with medium strength, so
+ * stronger constraints can stretch or squeeze them), and anything not
+ * constrained otherwise is at 0. The layout fits around the children, unless
+ * its size is set (setFixedSize()), or it's arranged by its parent (e.g. a
+ * Flex) to some other size.
+ *
+ * It's solved incrementally (see cassowary::Solver): when a child changes its
+ * size, or an edit variable is changed (e.g. a splitter being dragged, see
+ * suggestValue()), only what that affects is recomputed.
+ */
+class ConstraintLayout: public Layout
+{
+public:
+    using Variable = cassowary::Variable;
+    using Expression = cassowary::Expression;
+    using Constraint = cassowary::Constraint;
+    using ConstraintId = cassowary::Solver::ConstraintId;
+
+    // The variables of a rect (of a child, or of the layout)
+    struct Anchors
+    {
+        Variable left, top, width, height;
+
+        Expression right() const   { return Expression(left) + width; }
+        Expression bottom() const  { return Expression(top) + height; }
+        Expression centerX() const { return Expression(left) + Expression(width) / 2; }
+        Expression centerY() const { return Expression(top) + Expression(height) / 2; }
+    };
+
+    ConstraintLayout();
+
+    /**
+     * The anchors of a child (which must have been added already), or of the
+     * layout itself (whose left and top are 0)
+     */
+    const Anchors& anchors(const Widget* child) const;
+    const Anchors& anchors() const { return m_self; }
+
+    /**
+     * Returns 0 if it can't be satisfied (with the error printed to cerr)
+     */
+    ConstraintId addConstraint(const Constraint& c, double strength = cassowary::strength::required);
+    void removeConstraint(ConstraintId id);
+
+    /**
+     * Extra variables (e.g. for guides, or splitter positions), and setting
+     * them interactively (e.g. while dragging), which only re-solves what
+     * depends on them
+     */
+    Variable newVariable() { return m_solver.newVariable(); }
+    bool addEditVariable(Variable v, double strength = cassowary::strength::strong);
+    void suggestValue(Variable v, double value);
+    double value(Variable v) const { return m_solver.value(v); }
+
+    /**
+     * Set the size of the layout, instead of fitting it to the children
+     * A 0 component means "fit" in that direction.
+     */
+    ConstraintLayout* setFixedSize(const sf::Vector2f& size);
+
+    bool arrangesChildren() const override { return true; }
+
+private:
+    void onChildAdded(Widget* child) override;
+    void onChildResized(Widget* child) override;
+    void recomputeGeometry() override;
+    sf::Vector2f computeSize(const Constraints& constraints) override;
+    void onResized() override;
+
+    void suggestSize(const sf::Vector2f& size); // Of the layout (0: fit)
+    sf::Vector2f solvedSize() const;
+    void arrangeChildren();
+
+    cassowary::Solver m_solver;
+    Anchors m_self;
+    std::unordered_map<const Widget*, Anchors> m_anchors;
+    std::vector<Widget*> m_resized; // Children to remeasure
+    sf::Vector2f m_fixedSize; // See setFixedSize() (what's suggested for the size, except while arranging)
+};
+
+} // namespace
+
+#endif // GUI_CONSTRAINTLAYOUT_HPP
@@ -0,0 +1,92 @@
+#ifndef GUI_FLEXLAYOUT_HPP
+#define GUI_FLEXLAYOUT_HPP
+
+#include "sfw/Layout.hpp"
+#include "sfw/Geometry.hpp"
+
+#include <SFML/System/Vector2.hpp>
+
+#include <unordered_map>
+
+namespace sfw
+{
+
+/**
+ * Row (or column) of widgets, sharing the space of the layout, flexbox-style
+ *
+ * Unlike HBox and VBox (which just stack the widgets at their own size), the
+ * children can grow to fill the free space, or shrink if there's not enough
+ * of it, in proportion to their factors (see setFlex()), and be aligned or
+ * stretched across.
+ *
+ * Uses the measure/arrange protocol (see Widget::measure()): each child is
+ * measured once, then arranged in a single pass, also when the layout itself
+ * is resized by its parent (e.g. another Flex), or with setFixedSize() (e.g.
+ * to follow the window size).
+ */
+class Flex: public Layout
+{
+public:
+    // Across the direction of the layout
+    enum class Align { Start, Center, End, Stretch };
+    // Along the direction of the layout (if nothing grows to fill the space)
+    enum class Justify { Start, Center, End, SpaceBetween };
+
+    Flex(Orientation direction = Horizontal);
+
+    Flex* setDirection(Orientation direction);
+    Flex* setAlign(Align align);
+    Flex* setJustify(Justify justify);
+
+    /**
+     * Space between the children (default: Theme::MARGIN)
+     */
+    Flex* setGap(float gap);
+
+    /**
+     * Set the size of the layout, instead of fitting it to the children
+     * A 0 component means "fit" in that direction.
+     */
+    Flex* setFixedSize(const sf::Vector2f& size);
+
+    /**
+     * Set how a child shares the space along the layout
+     * @param grow: share of the free space it gets (0: none)
+     * @param shrink: share of the missing space it gives up (relative to its
+     *        basis, too)
+     * @param basis: its size before growing/shrinking (< 0: its measured size)
+     * (The default for every child is: 0, 1, -1)
+     */
+    Flex* setFlex(Widget* child, float grow, float shrink = 1, float basis = -1);
+
+    bool arrangesChildren() const override { return true; }
+
+private:
+    struct Item
+    {
+        float grow = 0;
+        float shrink = 1;
+        float basis = -1;
+    };
+
+    const Item& item(const Widget* child) const;
+    float gap() const;
+
+    void recomputeGeometry() override;
+    sf::Vector2f computeSize(const Constraints& constraints) override;
+    void onResized() override;
+
+    // Position the children for the current size
+    void arrangeChildren();
+
+    Orientation m_direction;
+    Align m_align = Align::Start;
+    Justify m_justify = Justify::Start;
+    float m_gap = -1; // < 0: Theme::MARGIN
+    sf::Vector2f m_fixedSize;
+    std::unordered_map<const Widget*, Item> m_items; // Only for the children set explicitly
+};
+
+} // namespace
+
+#endif // GUI_FLEXLAYOUT_HPP
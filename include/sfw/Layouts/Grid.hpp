@@ -0,0 +1,118 @@
+#ifndef GUI_GRIDLAYOUT_HPP
+#define GUI_GRIDLAYOUT_HPP
+
+#include "sfw/Layout.hpp"
+
+#include <SFML/System/Vector2.hpp>
+
+#include <vector>
+#include <unordered_map>
+#include <utility>
+#include <cstddef>
+
+namespace sfw
+{
+
+/**
+ * Table of widgets, in a fixed number of columns
+ *
+ * The children fill the cells row by row, in the order they are added,
+ * skipping the ones already covered by a span (see setSpan()). Each widget
+ * keeps its own size, at the top-left corner of its cell.
+ *
+ * The column widths and row heights are cached (along with the size of
+ * every cell), so when a widget changes its size, only its row and column
+ * (and those ending a span across them) are recomputed, and only the rows
+ * below a row that has actually changed its height are repositioned.
+ * (Adding widgets, or changing the spans, redoes the whole table, though.)
+ */
+class Grid: public Layout
+{
+public:
+    enum class Sizing
+    {
+        Auto,  // As wide as its widest cell (the default)
+        Fixed, // `value` pixels
+        Fill,  // Auto, plus a `value`-weighted share of the extra width, if
+               // the grid is arranged (e.g. stretched by a Flex) wider than that
+    };
+
+    Grid(size_t columns);
+
+    /**
+     * Set the number of columns and rows a child covers (from its cell)
+     * (The column span is limited to the number of columns.)
+     */
+    Grid* setSpan(Widget* child, size_t columns, size_t rows = 1);
+
+    Grid* setColumn(size_t column, Sizing sizing, float value = 0);
+
+    /**
+     * Space between the columns and rows (default: Theme::MARGIN)
+     */
+    Grid* setGap(float gap);
+
+    size_t columnCount() const { return m_columns.size(); }
+    size_t rowCount() const { return m_rows.size(); }
+
+    bool arrangesChildren() const override { return true; }
+
+private:
+    struct Cell
+    {
+        Widget* widget;
+        size_t row, col;
+        size_t rows, cols; // Span
+        sf::Vector2f size; // Measured
+    };
+
+    struct Column
+    {
+        Sizing sizing = Sizing::Auto;
+        float value = 0;
+        float base = 0;       // Widest single-column cell
+        bool rescan = false;  // The widest one has shrunk
+        bool changed = false; // The width needs recomputing
+    };
+
+    struct Row
+    {
+        size_t first = 0;     // The first cell starting in this row (they're sorted by row)
+        float base = 0;       // Tallest single-row cell
+        bool rescan = false;  // A cell in it has changed
+        bool changed = false; // The height needs recomputing
+    };
+
+    void onChildAdded(Widget* child) override;
+    void onChildResized(Widget* child) override;
+    void recomputeGeometry() override;
+    sf::Vector2f computeSize(const Constraints& constraints) override;
+    void onResized() override;
+    void onThemeChanged() override;
+
+    float gap() const;
+    void place();         // (Re)assign the cells, and measure everything
+    void updateExtents(); // Remeasure the changed cells, and their rows/columns
+    void invalidateExtents(); // Recompute every width and height (e.g. for a new gap)
+    void arrangeChildren();
+    void arrangeCell(const Cell& cell);
+
+    std::vector<Column> m_columns;
+    std::vector<Row> m_rows;
+    std::vector<Cell> m_cells; // In child order
+    std::vector<size_t> m_spanning; // Cells spanning more than one row or column
+    std::unordered_map<const Widget*, size_t> m_cellOf;
+    std::unordered_map<const Widget*, std::pair<size_t, size_t>> m_spans; // (columns, rows), if set
+    std::vector<size_t> m_changed; // Cells to remeasure
+    std::vector<size_t> m_resized; // Cells to rearrange (at their place, if nothing moves)
+    std::vector<float> m_colWidths, m_rowHeights; // With the spanning cells, too
+    std::vector<float> m_colPos, m_rowPos; // (Temporaries, just kept for their memory)
+    sf::Vector2f m_contentSize;
+    bool m_placed = false;
+    size_t m_arrangeFrom = 0; // The first row that has moved (> rowCount(): none)
+    float m_gap = -1; // < 0: Theme::MARGIN
+};
+
+} // namespace
+
+#endif // GUI_GRIDLAYOUT_HPP
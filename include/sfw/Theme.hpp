@@ -7,6 +7,7 @@
 #include <SFML/Window.hpp>
 #include <SFML/Window/Event.hpp>
 #include <SFML/Graphics/Font.hpp>
+#include <SFML/Graphics/Image.hpp>
 
 #include <map>
 #include <string>
@@ -55,6 +56,7 @@ public:
      */
     static bool loadTexture(const std::string& path);
     static const sf::Texture& getTexture();
+    static const sf::Image& getTextureImage(); // The same, in system memory (e.g. for gfx::Rasterizer)
 
     static const sf::IntRect& getTextureRect(Box::Type type, WidgetState state);
 
@@ -62,6 +64,12 @@ public:
     static const sf::IntRect& getArrowTextureRect();
     static const sf::IntRect& getProgressBarTextureRect();
 
+    /**
+     * Texture coords. of a white pixel in the theme texture (added after
+     * loading), for drawing untextured shapes in the same batch as the rest
+     */
+    static const sf::Vector2f& getSolidTexel();
+
     /**
      * Default widget height based on text size
      */
@@ -87,6 +95,11 @@ public:
 
     static sf::Color bgColor;
     static bool clearBackground;
+    // Draw text from distance-field glyphs (see gfx::SdfFont), which stay
+    // crisp at any size or scale (needs shader support, and a font loaded by
+    // loadFont(), else it's ignored; set it before creating the widgets, as
+    // it also changes how text is measured, see gfx::TextLayout)
+    static bool sdfText;
     static int borderSize; // Recalculated from the actual texture, so don't try setting it directly...
     static int minWidgetWidth;
 
@@ -116,7 +129,9 @@ private:
 
     static sf::Font m_font;
     static sf::Texture m_texture;
+    static sf::Image m_textureImage;
     static sf::IntRect m_subrects[_TEXTURE_ID_COUNT];
+    static sf::Vector2f m_solidTexel;
 };
 
 } // namsepace
@@ -11,8 +11,12 @@
 #include <optional>
 #include <variant>
 #include <string>
+#include <limits>
+#include <algorithm>
 
 #include <SFML/System/Vector2.hpp>
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Time.hpp>
 #include <SFML/Graphics/Transform.hpp>
 #include <SFML/Window/Event.hpp>
 
@@ -45,6 +49,38 @@ public:
     const sf::Vector2f& getSize() const;
     const sf::Transform& getTransform() const;
 
+    /**
+     * Two-pass layout protocol (for containers like Flex)
+     *
+     * measure() returns the size the widget would like to have within the
+     * given limits (its preferred size by default, i.e. what it has set for
+     * itself with setSize()), and arrange() then gives it its final place.
+     * The measurements are cached, until the preferred size of the widget
+     * (or, for containers, of anything below) changes, so a relayout only
+     * measures every widget once.
+     *
+     * arrange() doesn't change the preferred size, so a container stretching
+     * (or shrinking) a widget doesn't make it report a new one, to then be
+     * relaid out again. (Normally only called by the containers.)
+     */
+    struct Constraints
+    {
+        sf::Vector2f min{0, 0};
+        sf::Vector2f max{std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity()};
+        bool operator==(const Constraints&) const = default;
+
+        // Fit `size` into the limits (min wins, if they contradict)
+        sf::Vector2f clamp(const sf::Vector2f& size) const
+        {
+            return {std::clamp(size.x, min.x, std::max(min.x, max.x)),
+                    std::clamp(size.y, min.y, std::max(min.y, max.y))};
+        }
+    };
+    sf::Vector2f measure(const Constraints& constraints);
+    sf::Vector2f measure() { return measure(Constraints{}); } // Unconstrained
+    void arrange(const sf::FloatRect& rect);
+    const sf::Vector2f& getPreferredSize() const { return m_preferredSize; }
+
     /**
      * Check if a point is inside the widget
      */
@@ -57,6 +93,22 @@ public:
 
     bool isFocused() const;
 
+    /**
+     * Request the widget to be redrawn on the next GUI::render() call
+     * Widgets call this themselves whenever their appearance changes, so it's
+     * only needed after changing something they can't know about (e.g. the
+     * content of a texture they display, or the Theme colors).
+     * (No-op for widgets not attached to the GUI.)
+     */
+    void invalidate() const;
+
+    /**
+     * Request the widget to be redrawn after `delay` (e.g. for animating)
+     * (Like for invalidate(), but for the GUI::run() loop this also means that
+     * it can sleep until then, if nothing else is happening.)
+     */
+    void invalidate(sf::Time delay) const;
+
     /**
      * Set a function to be called when the "value" of the widget is changed
      */
@@ -121,6 +173,15 @@ friend class Layout;
     void setSize(const sf::Vector2f& size);
     void setSize(float width, float height);
 
+    /**
+     * Only report a new preferred size to the container (see measure()), but
+     * leave the current size alone, for it to arrange() (e.g. for widgets
+     * arranged by their container, which would otherwise lose their arranged
+     * size to the preferred one, to then be arranged again)
+     * Returns false if the preferred size hasn't changed.
+     */
+    bool setPreferredSize(const sf::Vector2f& size);
+
     sf::Vector2f getAbsolutePosition() const;
 
     void setState(WidgetState state);
@@ -174,6 +235,8 @@ friend class Layout;
 
 private:
     virtual void recomputeGeometry() {} // Can be requested by friend widgets, too
+    virtual sf::Vector2f computeSize(const Constraints& constraints); // For measure() (default: the preferred size, clamped)
+    void invalidateParentHitIndex() const; // After moving/resizing (see Layout::childAt())
 
     // Callbacks
     virtual void onStateChanged(WidgetState state);
@@ -188,6 +251,7 @@ private:
     virtual void onTextEntered(uint32_t unicode);
     virtual void onThemeChanged();
     virtual void onResized();
+    virtual void onInvalidated() const; // From invalidate() (even if not attached to the GUI)
 
     WidgetContainer* m_parent;
     Widget* m_previous;
@@ -196,10 +260,16 @@ private:
     WidgetState m_state;
     sf::Vector2f m_position;
     sf::Vector2f m_size;
+    sf::Vector2f m_preferredSize; // Set by setSize(); m_size may differ after arrange()
     bool m_selectable;
     Callback m_callback;
     sf::Transform m_transform;
 
+    // Cached measure() result
+    Constraints m_measuredFor;
+    sf::Vector2f m_measured;
+    bool m_measureValid = false;
+
 #ifdef DEBUG
 public:
 	void draw_outline(const gfx::RenderContext& ctx, sf::Color color = sf::Color::Red) const;
@@ -65,12 +65,42 @@ public:
     Widget* rbegin() const { return m_last; }
     //!! Make it std-compatible, so that all the std:: algorithms can be used on it! (#162)
 
+    /**
+     * Apply the pending layout changes in this subtree
+     *
+     * Resizing a widget, or adding one, doesn't relayout its container
+     * right away, only marks it (and the path up to the root) for it, and
+     * the dirty containers are then recomputed in one pass, bottom-up, each
+     * only once (no matter how many of its children have changed; only those
+     * (re)dirtied by arranging them in that pass get visited again). The GUI
+     * does this before processing an event, and before every frame (see
+     * GUI::updateLayout()), so this only needs to be called to query the
+     * new geometry (e.g. the size of a container) right after changing it.
+     */
+    void updateLayout();
+
+    /**
+     * Whether the container sizes its children (see Widget::arrange()), or
+     * they keep their own size, and are only positioned
+     */
+    virtual bool arrangesChildren() const { return false; }
+
 protected:
+friend class Widget; // For requestLayout() & co.
 
     // Helpers ---------------------------------------------------------------
     bool isChild(const Widget*);
     Widget* insertAfter(Widget* anchor, Widget* widget, const std::string& name);
 
+    // Mark this container for recomputeGeometry() by the next updateLayout()
+    // (Also drops the cached measurements of it, and of the containers above.)
+    void requestLayout();
+    bool layoutPending() const { return m_layoutDirty || m_childLayoutDirty; }
+
+    // Callbacks (for containers that keep track of their children) ----------
+    virtual void onChildAdded(Widget*) {}
+    virtual void onChildResized(Widget*) {} // Its preferred size, i.e. not by arrange()
+
     //!!This may also need to be defined in Widget instead, because client
     //!!code shouldn't really care whether some widgets can or cannot have
     //!!children! A pure tree structure in this regard too could be preferable.
@@ -81,6 +111,10 @@ protected:
 protected:
     Widget* m_first;
     Widget* m_last;
+
+private:
+    bool m_layoutDirty = false;      // Needs recomputeGeometry()
+    bool m_childLayoutDirty = false; // Some containers below need it
 };
 
 } // namespace
@@ -34,6 +34,7 @@ private:
     void recomputeGeometry() override;
 
     // Callbacks
+    void onResized() override;
     void onStateChanged(WidgetState state) override;
     void onMouseMoved(float x, float y) override;
     void onMousePressed(float x, float y) override;
@@ -0,0 +1,79 @@
+#ifndef GUI_CANVAS_HPP
+#define GUI_CANVAS_HPP
+
+#include "sfw/Widget.hpp"
+
+#include <SFML/Graphics/VertexBuffer.hpp>
+#include <SFML/Graphics/Vertex.hpp>
+#include <SFML/Graphics/PrimitiveType.hpp>
+#include <SFML/Graphics/Texture.hpp>
+
+#include <vector>
+#include <cstddef>
+
+namespace sfw
+{
+
+/**
+ * Widget for displaying custom (mostly static) geometry
+ *
+ * Unlike DrawHost, which re-runs its hook for every frame, the geometry is
+ * given once, and kept in a GPU vertex buffer (static usage), so drawing it
+ * costs one draw call, regardless of its size. Only the ranges changed by
+ * updateGeometry() are uploaded again.
+ *
+ * The vertices are in the widget's local coordinates, and are clipped to the
+ * widget's rect.
+ *
+ * A copy is also kept in system memory, for when the drawing doesn't go to
+ * the GPU directly (e.g. with the headless backend, gfx::Rasterizer, or
+ * GUI::startRenderThread()), or vertex buffers are not supported: the
+ * geometry is then drawn via the batching renderer instead.
+ */
+class Canvas: public Widget
+{
+public:
+    Canvas(const sf::Vector2f& size = {});
+
+    /**
+     * Replace the geometry (uploaded on the next draw)
+     * `texture` (if any) must outlive the widget (or the next setGeometry()).
+     */
+    Canvas* setGeometry(const sf::Vertex* vertices, size_t count, sf::PrimitiveType type,
+                        const sf::Texture* texture = nullptr);
+    Canvas* setGeometry(const std::vector<sf::Vertex>& vertices, sf::PrimitiveType type,
+                        const sf::Texture* texture = nullptr)
+        { return setGeometry(vertices.data(), vertices.size(), type, texture); }
+
+    /**
+     * Overwrite `count` vertices from `offset` (which must be within the
+     * current geometry); only the changed range is uploaded again
+     */
+    Canvas* updateGeometry(size_t offset, const sf::Vertex* vertices, size_t count);
+
+    const std::vector<sf::Vertex>& geometry() const { return m_vertices; }
+    sf::PrimitiveType primitiveType() const { return m_type; }
+
+    // Proxying some protected members:
+    void setSize(const sf::Vector2f& size)  { Widget::setSize(size); }
+    void setSize(float width, float height) { Widget::setSize(width, height); }
+
+private:
+    void draw(const gfx::RenderContext& ctx) const override;
+
+    // Upload whatever has changed since the last time (needs a GL context)
+    bool upload() const;
+
+    std::vector<sf::Vertex> m_vertices;
+    sf::PrimitiveType m_type = sf::PrimitiveType::Triangles;
+    const sf::Texture* m_texture = nullptr;
+
+    mutable sf::VertexBuffer m_buffer;
+    mutable bool m_recreate = true;            // The whole buffer must be (re)created
+    mutable size_t m_dirtyFrom = 0, m_dirtyTo = 0; // Vertex range to upload
+    mutable bool m_gpuFailed = false;          // Stick to the batching renderer then
+};
+
+} // namespace
+
+#endif // GUI_CANVAS_HPP
@@ -2,6 +2,7 @@
 #define GUI_DRAWHOST_HPP
 
 #include "sfw/Widget.hpp"
+#include "sfw/Gfx/OffscreenCache.hpp"
 
 #include <functional>
 
@@ -19,6 +20,27 @@ public:
     DrawHost(const DrawHook& drawHook);
     Widget* setDrawHook(const DrawHook& drawHook);
 
+    /**
+     * Run the hook into an offscreen texture (of the size of the widget), and
+     * then just paste that on every draw, until the widget is invalidated
+     * (by the client calling invalidate(), e.g. when the hook would draw
+     * something else now), or resized
+     *
+     * Without caching, the hook runs for every frame (as the widget can't
+     * know what it draws, it's assumed to be animating).
+     * The hook API is the same either way: it just gets the offscreen
+     * texture (and a renderer for it) as the target then. (The texture is
+     * in target pixels, and counts against the memory limit of all the
+     * caches; see gfx::OffscreenCache, and Layout::setCacheMemoryLimit().)
+     */
+    DrawHost* setCaching(bool enable);
+    bool caching() const { return m_caching; }
+
+    /**
+     * Is there an up-to-date cached rendering of the hook?
+     */
+    bool isCacheValid() const;
+
     // Proxying some protected members:
     void setSize(const sf::Vector2f& size)  { Widget::setSize(size); }
     void setSize(float width, float height) { Widget::setSize(width, height); }
@@ -26,8 +48,19 @@ public:
 
 private:
     void draw(const gfx::RenderContext& ctx) const override;
+    void onResized() override;
+    void onInvalidated() const override;
+
+    /**
+     * Draw via the offscreen cache (rebuilding it if needed)
+     * Returns false if the cache can't be used.
+     */
+    bool drawCached(const gfx::RenderContext& ctx) const;
 
     DrawHook m_drawHook;
+
+    bool m_caching = false;
+    gfx::OffscreenCache m_cache;
 };
 
 } // namespace
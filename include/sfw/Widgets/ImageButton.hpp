@@ -39,6 +39,7 @@ public:
 private:
     void draw(const gfx::RenderContext& ctx) const override;
 
+    void onResized() override;
     void onStateChanged(WidgetState state) override;
     void onMouseMoved(float x, float y) override;
     void onMousePressed(float x, float y) override;
@@ -84,6 +84,7 @@ private:
     void onKeyPressed(const sf::Event::KeyEvent& key) override;
     void onKeyReleased(const sf::Event::KeyEvent& key) override;
     void onThemeChanged() override;
+    void onResized() override;
 
     void updateArrowState(ItemBox<Arrow>& arrow, float x, float y);
 
@@ -1,4 +1,5 @@
 #include "sfw/Theme.hpp"
+#include "sfw/Gfx/TextLayout.hpp"
 #include "sfw/util/shims.hpp" // std::string <-> sf::String conv.
 #include "sfw/util/diagnostics.hpp"
 
@@ -32,15 +33,10 @@ auto OptionsBox<T>::add(const std::string& label, const T& value)
     m_items.push_back(Item(label, value));
 
     m_box.item().setString(/*sfw::*/stdstring_to_SFMLString(label));
-    float width = m_box.item().getLocalBounds().width + Theme::getBoxHeight() * 2 + Theme::PADDING * 2;
-    // Check if the box needs to be resized
-    if (width > getSize().x)
-    {
-        m_box.setSize(width, (float)Theme::getBoxHeight());
-        m_arrowRight.setPosition(width - (float)Theme::getBoxHeight(), 0.f);
-        m_arrowRight.centerItem(m_arrowRight.item());
-        setSize(m_box.getSize());
-    }
+    float width = gfx::textBounds(m_box.item()).width + Theme::getBoxHeight() * 2 + Theme::PADDING * 2;
+    // Check if the box needs to be resized (see onResized())
+    if (width > getPreferredSize().x)
+        setSize(width, (float)Theme::getBoxHeight());
 
     update_selection(m_items.size() - 1, false);
     return this;
@@ -124,6 +120,7 @@ template <class T>
 OptionsBox<T>* OptionsBox<T>::setTextColor(const sf::Color& color)
 {
     m_box.setItemColor(color);
+    invalidate();
     return this;
 }
 
@@ -133,6 +130,7 @@ OptionsBox<T>* OptionsBox<T>::setFillColor(const sf::Color& color)
     m_box.setFillColor(color);
     m_arrowLeft.setTintColor(color);
     m_arrowRight.setTintColor(color);
+    invalidate();
     return this;
 }
 
@@ -149,6 +147,7 @@ auto OptionsBox<T>::update_selection(size_t index, bool callTheCallback)
         m_box.item().setString(/*sfw::*/stdstring_to_SFMLString(m_items[index].label));
         m_box.centerTextHorizontally(m_box.item());
 
+        invalidate();
         if (callTheCallback) triggerCallback();
     }
     return this;
@@ -160,9 +159,9 @@ void OptionsBox<T>::draw(const gfx::RenderContext& ctx) const
 {
     auto sfml_renderstates = ctx.props;
     sfml_renderstates.transform *= getTransform();
-    ctx.target.draw(m_box, sfml_renderstates);
-    ctx.target.draw(m_arrowLeft, sfml_renderstates);
-    ctx.target.draw(m_arrowRight, sfml_renderstates);
+    ctx.renderer.draw(m_box, sfml_renderstates);
+    ctx.renderer.draw(m_arrowLeft, sfml_renderstates);
+    ctx.renderer.draw(m_arrowRight, sfml_renderstates);
 }
 
 
@@ -181,6 +180,7 @@ void OptionsBox<T>::updateArrowState(ItemBox<Arrow>& arrow, float x, float y)
     {
         arrow.applyState(isFocused() ? WidgetState::Focused : WidgetState::Default);
     }
+    invalidate();
 }
 
 
@@ -197,25 +197,36 @@ void OptionsBox<T>::onThemeChanged()
     for (size_t i = 0; i < m_items.size(); ++i)
     {
         m_box.item().setString(stdstring_to_SFMLString(m_items[i].label));
-        width = max(width, m_box.item().getLocalBounds().width + Theme::getBoxHeight() * 2 + Theme::PADDING * 2);
+        width = max(width, gfx::textBounds(m_box.item()).width + Theme::getBoxHeight() * 2 + Theme::PADDING * 2);
     }
-    m_box.setSize(width, (float)Theme::getBoxHeight());
-    setSize(m_box.getSize());
+    setSize(width, (float)Theme::getBoxHeight());
+    onResized(); // (setSize() doesn't call it, if the size hasn't changed, but the arrows may have.)
 
     //! Reset the current selection rolled all over in the loop above.
     //! This will also re-center it, so the widget had to have been resized first!
     update_selection(m_currentIndex, false);
+}
+
+
+template <class T>
+void OptionsBox<T>::onResized()
+{
+    m_box.setSize(getSize().x, getSize().y);
+    m_box.centerTextHorizontally(m_box.item());
+
+    // The arrows are squares at the two ends
+    float side = m_box.getSize().y;
 
     // Left arrow
-    m_arrowLeft.setSize(Theme::getBoxHeight(), Theme::getBoxHeight());
+    m_arrowLeft.setSize(side, side);
     m_arrowLeft.centerItem(m_arrowLeft.item());
 
     // Right arrow
-    m_arrowRight.setSize(Theme::getBoxHeight(), Theme::getBoxHeight());
-    m_arrowRight.setPosition(m_box.getSize().x - Theme::getBoxHeight(), 0);
+    m_arrowRight.setSize(side, side);
+    m_arrowRight.setPosition(m_box.getSize().x - side, 0);
     //!!WOW! Doing the same in reverse would make it fall apart spectacularly!! :-ooo
-    //!!m_arrowRight.setPosition(m_box.getSize().x - Theme::getBoxHeight(), 0);
-    //!!m_arrowRight.setSize(Theme::getBoxHeight(), Theme::getBoxHeight());
+    //!!m_arrowRight.setPosition(m_box.getSize().x - side, 0);
+    //!!m_arrowRight.setSize(side, side);
 
     m_arrowRight.centerItem(m_arrowRight.item());
 }
@@ -250,6 +261,7 @@ void OptionsBox<T>::onMousePressed(float x, float y)
 
     else if (m_arrowRight.containsPoint(x, y))
         m_arrowRight.press();
+    invalidate();
 }
 
 
@@ -266,6 +278,7 @@ void OptionsBox<T>::onMouseReleased(float x, float y)
         m_arrowRight.release();
         selectNext();
     }
+    invalidate(); // The selection may not have changed (e.g. with a single item)
 }
 
 
@@ -282,6 +295,7 @@ void OptionsBox<T>::onKeyPressed(const sf::Event::KeyEvent& key)
         selectNext();
         m_arrowRight.press();
     }
+    invalidate();
 }
 
 
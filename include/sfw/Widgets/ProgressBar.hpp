@@ -36,11 +36,15 @@ public:
 private:
     void draw(const gfx::RenderContext& ctx) const override;
 
+    // Callbacks
+    void onResized() override;
+
     Box m_box;
     Orientation m_orientation;
     sf::Vertex m_bar[4];
     sf::Text m_label;
     LabelPlacement m_labelPlacement;
+    float m_labelSpace = 0; // Taken from the length for the label, if it's outside
     float m_value;
 };
 
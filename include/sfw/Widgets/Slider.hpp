@@ -38,6 +38,7 @@ private:
     void updateHandlePosition();
 
     // Callbacks
+    void onResized() override;
     void onKeyPressed(const sf::Event::KeyEvent& key) override;
     void onMousePressed(float x, float y) override;
     void onMouseMoved(float x, float y) override;
@@ -8,7 +8,7 @@
 #include <string>
 
 #include <SFML/Graphics/Text.hpp>
-#include <SFML/Graphics/RectangleShape.hpp>
+#include <SFML/Graphics/Rect.hpp>
 #include <SFML/Graphics/Color.hpp>
 #include <SFML/System/Clock.hpp>
 
@@ -92,6 +92,8 @@ public:
 private:
     void draw(const gfx::RenderContext& ctx) const override;
 
+    void updateView();
+
     // Callbacks
     void onKeyPressed(const sf::Event::KeyEvent& key) override;
     void onKeyReleased(const sf::Event::KeyEvent& key) override;
@@ -103,6 +105,7 @@ private:
     void onTextEntered(uint32_t unicode) override;
     void onStateChanged(WidgetState state) override;
     void onThemeChanged() override;
+    void onResized() override;
 
     // Config:
     size_t m_maxLength;
@@ -115,7 +118,7 @@ private:
     size_t m_cursorPos; // Despite the name, this isn't a property of the visual cursor representation
     TextSelection m_selection;
     // Cursor visual state:
-    mutable sf::RectangleShape m_cursorRect;
+    sf::FloatRect m_cursorRect;
     mutable sf::Color m_cursorColor;
     mutable sf::Clock m_cursorTimer;
     // Widget state:
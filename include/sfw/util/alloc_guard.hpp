@@ -0,0 +1,48 @@
+#ifndef SFW_ALLOC_GUARD_HPP
+#define SFW_ALLOC_GUARD_HPP
+
+#include <cstddef>
+
+namespace sfw
+{
+
+/**
+ * Count the heap allocations of the current thread while alive
+ *
+ * Only functional if the lib has been built with SFW_ALLOC_GUARD defined
+ * (e.g. `make ALLOC_GUARD=1`), which replaces the global operator new (so
+ * it's intended for diagnostic builds only). Otherwise count() is always 0.
+ *
+ * The GUI uses it to verify that repainting doesn't allocate (see GUI::render()).
+ */
+class AllocationGuard
+{
+public:
+    AllocationGuard();
+
+    size_t count() const;
+
+    static constexpr bool enabled =
+#ifdef SFW_ALLOC_GUARD
+        true;
+#else
+        false;
+#endif
+
+    /**
+     * Exempt the allocations in its scope from being counted
+     * (For known, legit one-off allocations, like growing some pools.)
+     */
+    struct Pause
+    {
+        Pause();
+        ~Pause();
+    };
+
+private:
+    size_t m_start;
+};
+
+} // namespace
+
+#endif // SFW_ALLOC_GUARD_HPP
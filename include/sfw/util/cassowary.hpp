@@ -0,0 +1,184 @@
+#ifndef SFW_CASSOWARY_HPP
+#define SFW_CASSOWARY_HPP
+
+#include <vector>
+#include <map>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+
+namespace sfw
+{
+namespace cassowary
+{
+
+//============================================================================
+/**
+ * Incremental linear constraint solver (Cassowary)
+ *
+ * Keeps a simplex tableau of linear equalities/inequalities, each with a
+ * strength: `required` ones must hold, the others are satisfied as far as
+ * possible, stronger ones first.
+ *
+ * Adding or removing a constraint only pivots what it affects, and changing
+ * the value of an "edit" variable (e.g. the position of a splitter being
+ * dragged) is just a few dual simplex steps from the current solution,
+ * instead of solving everything again.
+ *
+ * Errors (e.g. conflicting required constraints) are printed to cerr, and
+ * the solver is left as it was.
+ * (After the Cassowary paper by Badros, Borning & Stuckey; see also Kiwi.)
+ */
+
+namespace strength
+{
+    constexpr double required = 1001001000.0;
+    constexpr double strong   = 1000000.0;
+    constexpr double medium   = 1000.0;
+    constexpr double weak     = 1.0;
+}
+
+// Handle of a variable of a Solver
+struct Variable
+{
+    size_t id = 0; // 0: none
+    // (No operator==, as `a == b` makes a Constraint of them.)
+};
+
+// Linear expression: sum(coeff * var) + constant
+struct Expression
+{
+    std::vector<std::pair<Variable, double>> terms;
+    double constant = 0;
+
+    Expression() = default;
+    Expression(double c): constant(c) {}
+    Expression(Variable v, double coeff = 1) { terms.emplace_back(v, coeff); }
+};
+
+Expression operator+(Expression a, const Expression& b);
+Expression operator-(Expression a, const Expression& b);
+Expression operator*(Expression a, double k);
+Expression operator*(double k, Expression a);
+Expression operator/(Expression a, double k);
+Expression operator-(Expression a);
+
+// `expr <op> 0`
+struct Constraint
+{
+    enum Op { LE, EQ, GE };
+    Expression expr;
+    Op op;
+};
+
+Constraint operator==(const Expression& a, const Expression& b);
+Constraint operator<=(const Expression& a, const Expression& b);
+Constraint operator>=(const Expression& a, const Expression& b);
+
+
+class Solver
+{
+public:
+    using ConstraintId = size_t; // 0: none (failed)
+
+    Variable newVariable();
+
+    /**
+     * Returns 0 if a required constraint can't be satisfied
+     */
+    ConstraintId add(const Constraint& c, double strength = strength::required);
+    bool remove(ConstraintId id);
+
+    /**
+     * Edit variables are the ones to be set from outside (via suggestValue())
+     * (`strength` can't be `required`.)
+     */
+    bool addEditVariable(Variable v, double strength = strength::strong);
+    bool removeEditVariable(Variable v);
+    bool hasEditVariable(Variable v) const { return m_edits.count(v.id) > 0; }
+    void suggestValue(Variable v, double value);
+
+    /**
+     * Update the values of the variables from the current solution
+     */
+    void updateVariables();
+    double value(Variable v) const { return v.id < m_values.size() ? m_values[v.id] : 0; }
+
+private:
+    struct Symbol
+    {
+        enum Type { Invalid, External, Slack, Error, Dummy };
+        std::uint64_t id = 0;
+        Type type = Invalid;
+        bool valid() const { return type != Invalid; }
+        bool operator<(const Symbol& other) const { return id < other.id; }
+        bool operator==(const Symbol& other) const { return id == other.id; }
+    };
+
+    struct Row
+    {
+        std::map<Symbol, double> cells;
+        double constant = 0;
+
+        double add(double value) { return constant += value; }
+        void insert(const Symbol& s, double coeff = 1);
+        void insert(const Row& other, double coeff = 1);
+        void remove(const Symbol& s) { cells.erase(s); }
+        void reverseSign();
+        void solveFor(const Symbol& s);
+        void solveFor(const Symbol& lhs, const Symbol& rhs);
+        double coeffFor(const Symbol& s) const;
+        void substitute(const Symbol& s, const Row& row);
+    };
+
+    // The symbols added for a constraint
+    struct Tag
+    {
+        Symbol marker, other;
+    };
+
+    struct ConstraintInfo
+    {
+        Tag tag;
+        double strength;
+    };
+
+    struct Edit
+    {
+        ConstraintId constraint;
+        Tag tag;
+        double constant = 0;
+    };
+
+    Symbol newSymbol(Symbol::Type type) { return {++m_lastSymbol, type}; }
+    Symbol varSymbol(Variable v);
+
+    Row createRow(const Constraint& c, double strength, Tag& tag);
+    Symbol chooseSubject(const Row& row, const Tag& tag) const;
+    bool addWithArtificialVariable(const Row& row);
+    void substitute(const Symbol& s, const Row& row);
+    bool optimize(Row& objective);
+    bool dualOptimize();
+    Symbol enteringSymbol(const Row& objective) const;
+    Symbol dualEnteringSymbol(const Row& row) const;
+    Symbol anyPivotableSymbol(const Row& row) const;
+    std::map<Symbol, Row>::iterator leavingRow(const Symbol& entering);
+    std::map<Symbol, Row>::iterator markerLeavingRow(const Symbol& marker);
+    void removeMarkerEffects(const Symbol& marker, double strength);
+
+    std::uint64_t m_lastSymbol = 0;
+    std::vector<Symbol> m_varSymbols; // By Variable::id
+    std::vector<double> m_values;     // By Variable::id
+    std::map<Symbol, Row> m_rows;     // The tableau (basic symbol -> its row)
+    std::map<ConstraintId, ConstraintInfo> m_constraints;
+    ConstraintId m_lastConstraint = 0;
+    std::map<size_t, Edit> m_edits;   // By Variable::id
+    std::vector<Symbol> m_infeasible;
+    Row m_objective;
+    Row* m_artificial = nullptr; // Only while adding a constraint with an artificial variable
+};
+
+} // namespace cassowary
+} // namespace sfw
+
+#endif // SFW_CASSOWARY_HPP
@@ -0,0 +1,57 @@
+#ifndef SFW_WORKER_POOL_HPP
+#define SFW_WORKER_POOL_HPP
+
+#include <functional>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstddef>
+
+namespace sfw
+{
+
+/**
+ * Fixed set of threads for running batches of independent jobs
+ *
+ * run() hands out the jobs one by one to whichever thread is free (the
+ * calling thread included), so uneven jobs still balance out, and returns
+ * when all of them are done. Nothing is allocated per run.
+ * (E.g. see GUI::setParallelBuild().)
+ */
+class WorkerPool
+{
+public:
+    WorkerPool(unsigned threads);
+    ~WorkerPool();
+
+    unsigned threads() const { return (unsigned)m_threads.size(); }
+
+    /**
+     * Call job(0) ... job(count - 1), in parallel, and wait for all of them
+     * (Not reentrant: a job can't run() the same pool again.)
+     */
+    void run(size_t count, const std::function<void(size_t)>& job);
+
+private:
+    void work();  // The loop of the threads
+    void drain(); // Take jobs until there are none left
+
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;
+    std::condition_variable m_wake, m_done;
+
+    // The current batch
+    const std::function<void(size_t)>* m_job = nullptr;
+    size_t m_count = 0;
+    std::atomic<size_t> m_next = 0;
+    size_t m_finished = 0;     // Jobs done
+    unsigned m_active = 0;     // Threads still in drain()
+    unsigned m_generation = 0; // To tell a new batch from the last one
+    bool m_stop = false;
+};
+
+} // namespace
+
+#endif // SFW_WORKER_POOL_HPP
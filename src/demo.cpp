@@ -244,6 +244,7 @@ int main()
 
 	// Bitmap buttons
 	auto imgbuttons_form = left_panel->add(sfw::Form());
+	imgbuttons_form->setCaching(true); // Mostly static, so just paste it from an offscreen texture
 	sf::Texture buttonimg; //! DON'T put this texture inside the if() as a local temporary!... ;)
 	if (buttonimg.loadFromFile("demo/sfmlwidgets-themed-button.png")) // SFML would print an error if failed
 	{
@@ -361,13 +362,14 @@ int main()
 	// A pretty useless, but interesting clear-background checkbox
 	auto hbox4 = right_bar->add(new sfw::HBox);
 	hbox4->add(sfw::Label("Clear background"));
-	hbox4->add(sfw::CheckBox([&](auto* w) { Theme::clearBackground = w->checked(); }, true));
+	hbox4->add(sfw::CheckBox([&](auto* w) { Theme::clearBackground = w->checked(); demo.damage(); }, true));
 
 	// Window background color selector
 	right_bar->add(new Form)->add("Bg. color", (new OBColor(ColorSelect_TEMPLATE))
 		->add("Default", themes[DEFAULT_THEME].bgColor)
 		->setCallback([&](auto* w) {
 			Theme::bgColor = w->current();
+			demo.damage(); // The GUI can't know about Theme changes made this way
 		})
 	);
 
@@ -391,23 +393,12 @@ int main()
 
 	//--------------------------------------------------------------------
 	// Start the event loop
-	while (window.isOpen())
-	{
-		// Render the GUI
-		demo.render();
-
-		// Show the updated window
-		window.display();
-
-		// Pass events to the GUI & check for closing or failure
-		sf::Event event;
-		while (window.pollEvent(event) && demo.process(event) )
-		{
-			// Just for convenience, close on Esc, too:
-			if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Escape)
-				window.close(); // 
-		}
-	}
+	// (Renders only when something has changed, and sleeps otherwise.)
+	demo.run([&](const sf::Event& event) {
+		// Just for convenience, close on Esc, too:
+		if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Escape)
+			window.close();
+	});
 
 	//--------------------------------------------------------------------
 	// Finish the bg. thread, too
@@ -427,9 +418,12 @@ void background_thread_main([[maybe_unused]] sfw::GUI& gui)
 	        this_thread::sleep_for(chrono::milliseconds(50));
 		++n;
 		sampletext_angle = sf::degrees(n*2.f);
-		if (auto rot_slider = (sfw::Slider*)gui.getWidget("rotation-slider"); rot_slider)
-		{
-			rot_slider->setValue(float(int(sampletext_angle.asDegrees()/3) % 100));
-		}
+		// Widgets must only be changed on the GUI thread:
+		gui.post([&gui, sampletext_angle] {
+			if (auto rot_slider = (sfw::Slider*)gui.getWidget("rotation-slider"); rot_slider)
+			{
+				rot_slider->setValue(float(int(sampletext_angle.asDegrees()/3) % 100));
+			}
+		});
 	}
 }
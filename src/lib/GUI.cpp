@@ -1,27 +1,67 @@
 #include "sfw/GUI-main.hpp"
 #include "sfw/Theme.hpp"
+#include "sfw/Gfx/OffscreenCache.hpp"
+#include "sfw/util/alloc_guard.hpp"
 
-//!! Stuff for clearing the bg. when not owning the entire window
-//!! (Should be moved to the Renderer!)
-#include <SFML/Graphics/RectangleShape.hpp>
+#include <SFML/Graphics/Sprite.hpp>
+#include <SFML/Graphics/Vertex.hpp>
+#include <SFML/Graphics/BlendMode.hpp>
 #include <SFML/Graphics/Color.hpp>
+#include <SFML/System/Sleep.hpp>
 
 #include <charconv>
 #include <system_error>
 #include <iostream> // for printing errors/warnings
 #include <cassert>
+#include <algorithm>
+    using std::min, std::max;
 using namespace std;
 
 namespace sfw
 {
 
+namespace {
+
+// Fill a rect of the target, without blending (i.e. also overwriting alpha)
+void fill(sf::RenderTarget& target, const sf::FloatRect& r, sf::Color color)
+{
+    const sf::Vertex quad[] = {
+        {{r.left, r.top}, color},
+        {{r.left, r.top + r.height}, color},
+        {{r.left + r.width, r.top}, color},
+        {{r.left + r.width, r.top + r.height}, color},
+    };
+    target.draw(quad, 4, sf::PrimitiveType::TriangleStrip, sf::BlendNone);
+}
+
+// Fill an area of the target given in pixels (regardless of its view)
+void fillPixels(sf::RenderTarget& target, const sf::IntRect& pixels, sf::Color color)
+{
+    sf::Vector2u size = target.getSize();
+    sf::FloatRect area(pixels);
+    sf::View pixelView(area);
+    pixelView.setViewport({{area.left  / (float)size.x, area.top    / (float)size.y},
+                           {area.width / (float)size.x, area.height / (float)size.y}});
+    target.setView(pixelView);
+    fill(target, area, color);
+}
+
+} // namespace
+
+
 //----------------------------------------------------------------------------
-GUI::GUI(sf::RenderWindow& window, const sfw::Theme::Cfg& themeCfg, bool own_the_window):
+GUI::GUI(sf::RenderTarget& target, const sfw::Theme::Cfg& themeCfg, bool own_the_window):
     m_error(), // no error by default
-    m_window(window),
+    m_target(target),
+    m_window(dynamic_cast<sf::RenderWindow*>(&target)),
+    m_renderer(m_framebuffer),
     m_own_the_window(own_the_window),
-    m_themeCfg(themeCfg)
+    m_themeCfg(themeCfg),
+    m_recordTarget({1, 1}),
+    m_recorder(m_recordTarget)
 {
+    m_recorder.setRecordOnly(true);
+
     // "Officially" mark this object as the "Main" in the GUI Widget tree:
     m_parent = this;
 
@@ -31,6 +71,13 @@ GUI::GUI(sf::RenderWindow& window, const sfw::Theme::Cfg& themeCfg, bool own_the
     reset();
 }
 
+GUI::~GUI()
+{
+    stopRenderThread();
+    stopCapture();
+    m_workers.reset(); // (Before the rest of the members it uses.)
+}
+
 
 //----------------------------------------------------------------------------
 bool GUI::active()
@@ -61,8 +108,11 @@ void GUI::close()
 {
 	m_closed = true;
 
+	stopRenderThread(); // The window is used by that, too
+	stopCapture();
+
 	// Do we control the window, too (or just the widgets)?
-	if (m_own_the_window) m_window.close();
+	if (m_own_the_window && m_window) m_window->close();
 }
 
 //----------------------------------------------------------------------------
@@ -70,6 +120,8 @@ bool GUI::process(const sf::Event& event)
 {
     if (!active()) return false;
 
+    updateLayout();
+
     switch (event.type)
     {
     case sf::Event::MouseMoved:
@@ -111,6 +163,10 @@ bool GUI::process(const sf::Event& event)
         onTextEntered(event.text.unicode);
         break;
 
+    case sf::Event::Resized:
+        damage(); // (The framebuffer will also be recreated for the new size.)
+        break;
+
     case sf::Event::Closed:
 	close();
         return false;
@@ -136,6 +192,9 @@ bool GUI::setTheme(const sfw::Theme::Cfg& themeCfg)
         m_themeCfg = themeCfg;
     }
 
+    // The textures etc. may be in use by the render thread
+    waitForRenderThread();
+
     // Do this even if the config has not been changed, to allow calling from the ctor!
     if (!m_themeCfg.apply())
     {
@@ -146,6 +205,7 @@ bool GUI::setTheme(const sfw::Theme::Cfg& themeCfg)
 
     // Notify widgets of the change
     traverseChildren([](Widget* w) { w->onThemeChanged(); } );
+    damage(); // Colors etc. may have changed even where the geometry hasn't
         // Another reason to not use the widget registry map (besides "frugalism"
         // and that it's not even intended for this (i.e. it may not even contain
         // every widget!) that std::map reorders its content alphabetically,
@@ -154,39 +214,549 @@ bool GUI::setTheme(const sfw::Theme::Cfg& themeCfg)
     //! This would be redundant in the current model:
     //!traverseChildren([](Widget* w) { w->recomputeGeometry(); } );
     //! The onThemeChanged() call typically involves setSize() too, which
-    //! in turn also calls parent->recomputeGeometry() (via Widget::setSize)!
-    //! (NOTE: there are ample chances of infinite looping here too, some of
-    //! which I've duly explored already...)
+    //! in turn also marks the parent for relayout (via Widget::setSize),
+    //! and all that gets recomputed in one go by the next updateLayout().
 
     return true;
 }
 
 
 //----------------------------------------------------------------------------
-void GUI::render()
+bool GUI::render()
 {
-    if (!active()) return;
+    if (!active()) return false;
+
+    bool repainted = update();
+    if (renderThreadRunning()) return repainted; // (Composited by the render thread.)
+    if (m_framebuffer.getSize() != m_target.getSize()) return repainted; // (Failed to create it.)
+
+    composite();
+    if (m_capture) m_capture->capture(m_target);
+    return repainted;
+}
 
-    if (sfw::Theme::clearBackground)
+
+void GUI::composite()
+{
+    // Copy the framebuffer to the target (1:1, regardless of its current view)
+    sf::View view = m_target.getView();
+    m_target.setView(m_target.getDefaultView());
+    // The framebuffer has been alpha-blended onto a transparent background,
+    // so its content is effectively alpha-premultiplied:
+    m_target.draw(sf::Sprite(m_framebuffer.getTexture()),
+                  sf::BlendMode(sf::BlendMode::Factor::One, sf::BlendMode::Factor::OneMinusSrcAlpha));
+    m_target.setView(view);
+}
+
+
+//----------------------------------------------------------------------------
+bool GUI::update()
+{
+    if (!active()) return false;
+
+    runPostedTasks();
+    updateLayout(); // (After the tasks, as they may well change the layout.)
+    applyScheduledRepaints();
+
+    return repaint();
+}
+
+
+void GUI::updateLayout()
+{
+    WidgetContainer::updateLayout();
+}
+
+
+//----------------------------------------------------------------------------
+bool GUI::repaint()
+{
+    const sf::View& view = guiView();
+    gfx::OffscreenCache::nextFrame(); // (The caches drawn from now on are not to be dropped for others.)
+
+    // Repaint everything on the first call, and whenever the target is resized
+    sf::Vector2u size = m_target.getSize();
+    if (size != m_lastSize)
     {
-        if (m_own_the_window)
+        m_lastSize = size;
+        m_fullRepaint = true;
+        m_warmedUp = false;
+    }
+
+    // (Re)create the framebuffer for that (or let the render thread do it)
+    if (!renderThreadRunning() && m_framebuffer.getSize() != size && !m_framebuffer.create(size))
+    {
+        m_error = make_error_code(errc::not_enough_memory); //!!Should actually be a custom one!
+        cerr << "- ERROR: Failed to create the GUI framebuffer!\n";
+        return false;
+    }
+
+    // A changed view moves everything
+    if (view.getTransform() != m_lastView.getTransform() || view.getViewport() != m_lastView.getViewport())
+    {
+        m_lastView = view;
+        m_fullRepaint = true;
+    }
+
+    std::optional<sf::IntRect> pixels;
+    if (m_fullRepaint)
+    {
+        pixels = sf::IntRect({0, 0}, sf::Vector2i(size));
+    }
+    else if (m_damage)
+    {
+        // Find the pixels covered by the damaged area (with a 1px margin for
+        // rounding and antialiasing)
+        const sf::FloatRect& d = *m_damage;
+        sf::Vector2i corners[] = {
+            m_target.mapCoordsToPixel({d.left, d.top}, view),
+            m_target.mapCoordsToPixel({d.left + d.width, d.top}, view),
+            m_target.mapCoordsToPixel({d.left, d.top + d.height}, view),
+            m_target.mapCoordsToPixel({d.left + d.width, d.top + d.height}, view),
+        };
+        sf::Vector2i topleft = corners[0], bottomright = corners[0];
+        for (auto& c : corners)
         {
-            m_window.clear(Theme::bgColor);
+            topleft = {min(topleft.x, c.x), min(topleft.y, c.y)};
+            bottomright = {max(bottomright.x, c.x), max(bottomright.y, c.y)};
         }
-        else
+        topleft -= {1, 1}; bottomright += {2, 2};
+        pixels = sf::IntRect(topleft, bottomright - topleft)
+                 .findIntersection(sf::IntRect({0, 0}, sf::Vector2i(size)));
+    }
+
+    // Reset the damage before drawing, as widgets may also invalidate themselves
+    // while being drawn (e.g. for animating), which should then go to the next frame
+    m_damage.reset();
+    m_fullRepaint = false;
+
+    if (!pixels || pixels->width <= 0 || pixels->height <= 0) return false;
+
+    AllocationGuard allocGuard; // (No-op, unless built with SFW_ALLOC_GUARD.)
+    m_partAllocations = 0; // (The guard only sees this thread, see recordPart().)
+
+    sf::Color clearColor = sfw::Theme::clearBackground && m_own_the_window ? Theme::bgColor : sf::Color::Transparent;
+    sf::View clipView = gfx::Renderer::clipView(view, *pixels, size); // Restrict the drawing to the damaged area
+
+    if (renderThreadRunning())
+    {
+        // Wait for the render thread to pick up the previous frame
+        std::unique_lock lock(m_frameMutex);
+        m_frameChanged.wait(lock, [this] { return !m_framePending; });
+        lock.unlock();
+
+        Frame& frame = m_frames[0];
+        m_recordTarget.setSize(size);
+        m_recordTarget.setView(clipView);
         {
-            // Just clear the GUI rect!
-            sf::RectangleShape bgRect(getSize());
-            bgRect.setPosition(getPosition());
-            bgRect.setFillColor(Theme::bgColor);
-            bgRect.setOutlineThickness(0);
-            //!!m_renderer.draw(bgRect);
-            m_window.draw(bgRect);
-	}
+            std::lock_guard resources(m_resourceMutex);
+            record(m_recorder);
+        }
+        {
+            AllocationGuard::Pause exempt; // (Only allocates when growing.)
+            frame.list = m_recorder.drawList();
+        }
+        frame.pixels = *pixels;
+        frame.clearColor = clearColor;
+        frame.size = size;
+
+        lock.lock();
+        m_framePending = true;
+        lock.unlock();
+        m_frameChanged.notify_all();
+    }
+    else
+    {
+        // Clear the damaged area (in pixel space)
+        fillPixels(m_framebuffer, *pixels, clearColor);
+
+        m_framebuffer.setView(clipView);
+        record(m_renderer);
+        m_framebuffer.display();
+    }
+
+    if (size_t allocations = allocGuard.count() + m_partAllocations; m_warmedUp && allocations)
+    {
+        cerr << "- ERROR: Repainting the GUI has allocated memory (" << allocations << " times)!\n";
+        assert(!"Repainting allocated memory (see SFW_ALLOC_GUARD)");
+    }
+    m_warmedUp = true;
+
+    return true;
+}
+
+
+void GUI::record(gfx::Renderer& renderer)
+{
+    renderer.begin();
+
+    if (sfw::Theme::clearBackground && !m_own_the_window)
+    {
+        // Just clear the GUI rect!
+        sf::FloatRect r(getPosition(), getSize());
+        const sf::Vertex quad[] = {
+            {{r.left, r.top}, Theme::bgColor},
+            {{r.left, r.top + r.height}, Theme::bgColor},
+            {{r.left + r.width, r.top}, Theme::bgColor},
+            {{r.left + r.width, r.top + r.height}, Theme::bgColor},
+        };
+        renderer.draw(quad, 4, sf::PrimitiveType::TriangleStrip, sf::BlendNone);
     }
 
     // Draw whatever we have, via our a top-level widget container ancestor
-    /*m_renderer.*/draw(gfx::RenderContext{m_window, sf::RenderStates()}); //! function-style RenderContext(...) failed with CLANG
+    if (m_workers)
+        recordInParallel(renderer);
+    else
+        draw(gfx::RenderContext{renderer.target(), sf::RenderStates::Default, renderer});
+
+    renderer.end();
+}
+
+
+//----------------------------------------------------------------------------
+void GUI::setParallelBuild(unsigned threads)
+{
+    waitForRenderThread(); // (May be building a frame with the old setup.)
+
+    m_workers.reset();
+    if (threads)
+    {
+        m_workers = std::make_unique<WorkerPool>(threads);
+        m_partJob = [this](size_t i) { recordPart(i); };
+    }
+}
+
+void GUI::recordInParallel(gfx::Renderer& renderer)
+{
+    // The same as Layout::draw() (without the caching), just the children
+    // are drawn by separate renderers
+    m_partStates = sf::RenderStates::Default;
+    m_partStates.transform *= getTransform();
+    if (clipping()) renderer.pushClip({{0, 0}, getSize()}, m_partStates.transform);
+
+    sf::FloatRect visible = renderer.clipArea(m_partStates.transform);
+    m_partRoots.clear();
+    for (const Widget* widget = begin(); widget != end(); widget = next(widget))
+    {
+        if (!mayBeVisible(widget, visible))
+            continue;
+        AllocationGuard::Pause exempt; // (Only allocates when growing.)
+        m_partRoots.push_back(widget);
+    }
+
+    // Set up the renderers to draw like the main one would
+    const sf::RenderTarget& target = renderer.target();
+    for (size_t i = 0; i < m_partRoots.size(); ++i)
+    {
+        if (i == m_parts.size())
+        {
+            AllocationGuard::Pause exempt; // (Ditto.)
+            auto& part = *m_parts.emplace_back(std::make_unique<Part>());
+            part.renderer.setRecordOnly(true);
+            part.renderer.setFontLock(&m_fontMutex);
+        }
+        m_parts[i]->target.setSize(target.getSize());
+        m_parts[i]->target.setView(target.getView());
+    }
+
+    m_workers->run(m_partRoots.size(), m_partJob);
+
+    // Stitch the results together, in the original order
+    for (size_t i = 0; i < m_partRoots.size(); ++i)
+        renderer.append(m_parts[i]->renderer.drawList());
+
+    if (clipping()) renderer.popClip();
+}
+
+void GUI::recordPart(size_t index)
+{
+    // The allocation counts are per thread, so this one's are added up
+    // separately (see repaint())
+    AllocationGuard allocGuard;
+
+    Part& part = *m_parts[index];
+    part.renderer.begin();
+    if (clipping()) part.renderer.pushClip({{0, 0}, getSize()}, m_partStates.transform);
+    m_partRoots[index]->draw(gfx::RenderContext{part.target, m_partStates, part.renderer});
+    if (clipping()) part.renderer.popClip();
+    part.renderer.end();
+
+    m_partAllocations += allocGuard.count();
+}
+
+
+//----------------------------------------------------------------------------
+void GUI::startRenderThread(std::function<void(sf::RenderTarget&)> underlay)
+{
+    if (renderThreadRunning()) return;
+
+    m_underlay = std::move(underlay);
+    m_threadView = m_target.getView();
+    m_framePending = m_frameInFlight = m_stopRenderThread = false;
+    m_fullRepaint = true; // The framebuffer may be recreated by the render thread
+
+    // The GL context of the target can only be active in one thread
+    if (!m_target.setActive(false))
+        cerr << "- Warning: Failed to release the render target for the render thread.\n";
+
+    m_renderThread = std::thread([this] { renderThread(); });
+}
+
+void GUI::stopRenderThread()
+{
+    if (!renderThreadRunning()) return;
+
+    {
+        std::lock_guard lock(m_frameMutex);
+        m_stopRenderThread = true;
+    }
+    m_frameChanged.notify_all();
+    m_renderThread.join(); // (It submits the pending frame first.)
+}
+
+void GUI::waitForRenderThread()
+{
+    std::unique_lock lock(m_frameMutex);
+    m_frameChanged.wait(lock, [this] { return !m_framePending && !m_frameInFlight; });
+}
+
+
+void GUI::renderThread()
+{
+    if (!m_target.setActive(true))
+        cerr << "- ERROR: Failed to activate the render target in the render thread!\n";
+
+    for (;;)
+    {
+        {
+            std::unique_lock lock(m_frameMutex);
+            m_frameChanged.wait(lock, [this] { return m_framePending || m_stopRenderThread; });
+            if (!m_framePending) break; // Stopped (with nothing left to submit)
+
+            std::swap(m_frames[0], m_frames[1]); // (Just swapping the buffers, no copying.)
+            m_framePending = false;
+            m_frameInFlight = true;
+        }
+        m_frameChanged.notify_all();
+
+        present(m_frames[1]);
+
+        {
+            std::lock_guard lock(m_frameMutex);
+            m_frameInFlight = false;
+        }
+        m_frameChanged.notify_all();
+    }
+
+    (void)m_target.setActive(false); // Hand it back
+}
+
+
+void GUI::present(const Frame& frame)
+{
+    {
+        std::lock_guard resources(m_resourceMutex);
+
+        if (m_framebuffer.getSize() != frame.size && !m_framebuffer.create(frame.size))
+        {
+            cerr << "- ERROR: Failed to create the GUI framebuffer!\n";
+            return;
+        }
+
+        fillPixels(m_framebuffer, frame.pixels, frame.clearColor);
+        m_renderer.submit(frame.list);
+        m_framebuffer.display();
+
+        m_target.clear();
+        if (m_underlay)
+            m_underlay(m_target);
+        composite();
+        if (m_capture) m_capture->capture(m_target);
+    }
+
+    // Outside the lock: this is what may block for long (e.g. waiting for vsync)
+    if (m_window)
+        m_window->display();
+}
+
+
+//----------------------------------------------------------------------------
+bool GUI::startCapture(const std::string& path, gfx::FrameCapture::Format format, unsigned fps)
+{
+    stopCapture();
+
+    auto capture = std::make_unique<gfx::FrameCapture>(path, format, fps);
+    if (!capture->ok())
+        return false;
+
+    std::lock_guard resources(m_resourceMutex); // (The render thread may be presenting.)
+    m_capture = std::move(capture);
+    return true;
+}
+
+void GUI::stopCapture()
+{
+    std::unique_ptr<gfx::FrameCapture> capture;
+    {
+        std::lock_guard resources(m_resourceMutex);
+        capture = std::move(m_capture);
+    }
+    if (!capture) return;
+
+    capture->finish(); // (Outside the lock, so the render thread can go on meanwhile.)
+    m_captureStats = capture->stats();
+}
+
+gfx::FrameCapture::Stats GUI::captureStats() const
+{
+    return m_capture ? m_capture->stats() : m_captureStats;
+}
+
+
+//----------------------------------------------------------------------------
+void GUI::damage(const sf::FloatRect& area)
+{
+    if (!m_damage)
+    {
+        m_damage = area;
+        return;
+    }
+
+    // Just a simple union (good enough for the typical cases of a few
+    // widgets changing at once, with no hassle of tracking rect lists)
+    sf::FloatRect& d = *m_damage;
+    float right  = max(d.left + d.width,  area.left + area.width);
+    float bottom = max(d.top  + d.height, area.top  + area.height);
+    d.left = min(d.left, area.left);
+    d.top  = min(d.top,  area.top);
+    d.width  = right  - d.left;
+    d.height = bottom - d.top;
+}
+
+void GUI::damage()
+{
+    m_fullRepaint = true;
+
+    // Things may have changed that the widgets can't know about (like Theme
+    // colors), so the offscreen layout caches need to be rebuilt, too
+    traverseChildren([](Widget* w) { if (auto* layout = w->toLayout(); layout) layout->invalidateCache(); } );
+}
+
+
+//----------------------------------------------------------------------------
+void GUI::scheduleRepaint(const Widget* widget, sf::Time delay)
+{
+    sf::Time due = m_clock.getElapsedTime() + delay;
+    for (auto& r : m_scheduledRepaints)
+    {
+        if (r.widget == widget)
+        {
+            r.due = min(r.due, due);
+            return;
+        }
+    }
+    AllocationGuard::Pause exempt; // (Only allocates when growing, which is not a per-frame cost.)
+    m_scheduledRepaints.push_back({due, widget});
+}
+
+void GUI::applyScheduledRepaints()
+{
+    sf::Time now = m_clock.getElapsedTime();
+    std::erase_if(m_scheduledRepaints, [now](const ScheduledRepaint& r) {
+        if (r.due > now) return false;
+        r.widget->invalidate();
+        return true;
+    });
+}
+
+
+//----------------------------------------------------------------------------
+std::optional<sf::Time> GUI::nextFrameDeadline() const
+{
+    if (m_fullRepaint || m_damage) return sf::Time::Zero;
+    {
+        std::lock_guard lock(m_postedTasksMutex);
+        if (!m_postedTasks.empty()) return sf::Time::Zero;
+    }
+
+    if (m_scheduledRepaints.empty()) return std::nullopt;
+
+    sf::Time next = m_scheduledRepaints.front().due;
+    for (auto& r : m_scheduledRepaints) next = min(next, r.due);
+
+    sf::Time now = m_clock.getElapsedTime();
+    return next > now ? next - now : sf::Time::Zero;
+}
+
+
+//----------------------------------------------------------------------------
+void GUI::post(std::function<void()> task)
+{
+    std::lock_guard lock(m_postedTasksMutex);
+    m_postedTasks.push_back(std::move(task));
+}
+
+void GUI::runPostedTasks()
+{
+    // Not holding the lock while running them, as they may also post() more
+    decltype(m_postedTasks) tasks;
+    {
+        std::lock_guard lock(m_postedTasksMutex);
+        tasks.swap(m_postedTasks);
+    }
+    for (auto& task : tasks) task();
+}
+
+
+//----------------------------------------------------------------------------
+void GUI::run(const std::function<void(const sf::Event&)>& eventHook)
+{
+    if (!m_window)
+    {
+        cerr << "- ERROR: GUI::run() needs a window to get the events from!\n";
+        return;
+    }
+    sf::RenderWindow& window = *m_window;
+
+    while (active() && window.isOpen())
+    {
+        if (render() && !renderThreadRunning())
+            window.display();
+        // else: the window still shows the same, no need to wait for vsync etc.
+
+        // Wait for the next event, or until the next frame is due
+        sf::Event event;
+        bool got_event = false;
+        for (;;)
+        {
+            if (window.pollEvent(event)) { got_event = true; break; }
+
+            auto deadline = nextFrameDeadline();
+            if (deadline && *deadline == sf::Time::Zero) break;
+
+            if (!deadline && m_blockWhenIdle)
+            {
+                got_event = window.waitEvent(event);
+                break;
+            }
+
+            sf::sleep(deadline ? min(*deadline, m_idlePollInterval) : m_idlePollInterval);
+        }
+
+        // Process all the pending events
+        while (got_event)
+        {
+            process(event); // (Closing would end the loop via active().)
+            if (eventHook) eventHook(event);
+            got_event = window.pollEvent(event);
+        }
+    }
+}
+
+void GUI::setIdlePolling(sf::Time pollInterval, bool blockWhenIdle)
+{
+    m_idlePollInterval = pollInterval;
+    m_blockWhenIdle = blockWhenIdle;
 }
 
 
@@ -259,7 +829,7 @@ string GUI::recall(const Widget* w) const
 //----------------------------------------------------------------------------
 sf::Vector2f GUI::convertMousePosition(int x, int y) const
 {
-    sf::Vector2f mouse = m_window.mapPixelToCoords(sf::Vector2i(x, y));
+    sf::Vector2f mouse = m_target.mapPixelToCoords(sf::Vector2i(x, y), guiView());
     mouse -= getPosition();
     return mouse;
 }
@@ -270,9 +840,13 @@ void GUI::setMouseCursor(sf::Cursor::Type cursorType)
 {
     if (cursorType != m_cursorType)
     {
-        if (Theme::cursor.loadFromSystem(cursorType))
+        if (!m_window) // Just for the app to see then
+        {
+            m_cursorType = cursorType;
+        }
+        else if (Theme::cursor.loadFromSystem(cursorType))
         {
-            m_window.setMouseCursor(Theme::cursor);
+            m_window->setMouseCursor(Theme::cursor);
             m_cursorType = cursorType;
         }
     }
@@ -0,0 +1,410 @@
+#include "sfw/Gfx/FrameCapture.hpp"
+#include "sfw/Gfx/Render.hpp"
+
+#include <SFML/Graphics/RenderTexture.hpp>
+#include <SFML/Graphics/Image.hpp>
+#include <SFML/Window/Context.hpp>
+#include <SFML/OpenGL.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <type_traits>
+#include <iostream>
+    using std::cerr;
+
+#ifndef APIENTRY
+#define APIENTRY
+#endif
+
+namespace sfw
+{
+namespace gfx
+{
+
+namespace
+{
+    // Not all the GL headers around have these (most only do GL 1.1):
+    namespace gl
+    {
+        constexpr GLenum PIXEL_PACK_BUFFER    = 0x88EB;
+        constexpr GLenum STREAM_READ          = 0x88E1;
+        constexpr GLenum SYNC_GPU_COMMANDS_COMPLETE = 0x9117;
+        constexpr GLenum ALREADY_SIGNALED     = 0x911A;
+        constexpr GLenum CONDITION_SATISFIED  = 0x911C;
+        constexpr GLbitfield SYNC_FLUSH_COMMANDS_BIT = 0x0001;
+        constexpr GLbitfield MAP_READ_BIT     = 0x0001;
+    }
+
+    // RGB -> YCbCr (BT.601, full range, as in JPEG; see "C420jpeg")
+    inline std::uint8_t luma(int r, int g, int b)
+    {
+        return (std::uint8_t)((77 * r + 150 * g + 29 * b + 128) >> 8);
+    }
+    inline std::uint8_t cb(int r, int g, int b)
+    {
+        return (std::uint8_t)std::clamp(((-43 * r - 85 * g + 128 * b + 128) >> 8) + 128, 0, 255);
+    }
+    inline std::uint8_t cr(int r, int g, int b)
+    {
+        return (std::uint8_t)std::clamp(((128 * r - 107 * g - 21 * b + 128) >> 8) + 128, 0, 255);
+    }
+} // namespace
+
+
+//----------------------------------------------------------------------------
+struct FrameCapture::Functions
+{
+    void      (APIENTRY* ReadPixels)(GLint, GLint, GLsizei, GLsizei, GLenum, GLenum, void*);
+    void      (APIENTRY* Flush)();
+    void      (APIENTRY* GenBuffers)(GLsizei, GLuint*);
+    void      (APIENTRY* DeleteBuffers)(GLsizei, const GLuint*);
+    void      (APIENTRY* BindBuffer)(GLenum, GLuint);
+    void      (APIENTRY* BufferData)(GLenum, std::ptrdiff_t, const void*, GLenum);
+    void*     (APIENTRY* MapBufferRange)(GLenum, std::ptrdiff_t, std::ptrdiff_t, GLbitfield);
+    GLboolean (APIENTRY* UnmapBuffer)(GLenum);
+    void*     (APIENTRY* FenceSync)(GLenum, GLbitfield);
+    GLenum    (APIENTRY* ClientWaitSync)(void*, GLbitfield, std::uint64_t);
+    void      (APIENTRY* DeleteSync)(void*);
+
+    bool load()
+    {
+        bool ok = true;
+        auto get = [&ok](auto& fn, const char* name) {
+            fn = reinterpret_cast<std::remove_reference_t<decltype(fn)>>(sf::Context::getFunction(name));
+            if (!fn) ok = false;
+        };
+        get(ReadPixels, "glReadPixels");     get(Flush, "glFlush");
+        get(GenBuffers, "glGenBuffers");     get(DeleteBuffers, "glDeleteBuffers");
+        get(BindBuffer, "glBindBuffer");     get(BufferData, "glBufferData");
+        get(MapBufferRange, "glMapBufferRange"); get(UnmapBuffer, "glUnmapBuffer");
+        get(FenceSync, "glFenceSync");       get(ClientWaitSync, "glClientWaitSync");
+        get(DeleteSync, "glDeleteSync");
+        return ok;
+    }
+};
+
+
+//============================================================================
+FrameCapture::FrameCapture(const std::string& path, Format format, unsigned fps):
+    m_path(path),
+    m_format(format),
+    m_fps(fps ? fps : 30),
+    m_gl(std::make_unique<Functions>())
+{
+    if constexpr (Renderer::headless)
+    {
+        cerr << "- ERROR: Frame capture is not available with the headless backend!\n";
+        return;
+    }
+
+    if (m_format == Format::Y4M)
+    {
+        m_file.open(m_path, std::ios::binary);
+        if (!m_file)
+        {
+            cerr << "- ERROR: Failed to create the capture file \"" << m_path << "\"!\n";
+            return;
+        }
+    }
+
+    for (unsigned i = 0; i < QUEUE; ++i)
+        m_free.push_back(std::make_unique<Frame>());
+    m_worker = std::thread([this] { encoder(); });
+    m_ok = true;
+}
+
+
+FrameCapture::~FrameCapture()
+{
+    finish();
+}
+
+
+void FrameCapture::finish()
+{
+    m_ok = false;
+
+    if (m_glReady)
+    {
+        sf::Context context; // The capturing context may not be active here (the objects are shared)
+        collect(true);
+        for (auto& slot : m_slots)
+            m_gl->DeleteBuffers(1, &slot.pbo);
+        m_glReady = false;
+    }
+
+    if (m_worker.joinable())
+    {
+        {
+            std::lock_guard lock(m_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_all();
+        m_worker.join(); // (It finishes the queue first.)
+
+        if (m_stats.dropped)
+            cerr << "- Warning: Frame capture has dropped " << m_stats.dropped << " frames (of "
+                 << m_stats.dropped + m_stats.written << ")!\n";
+    }
+    m_file.close();
+}
+
+
+FrameCapture::Stats FrameCapture::stats() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_stats;
+}
+
+
+bool FrameCapture::initGL()
+{
+    if (!m_gl->load())
+    {
+        cerr << "- ERROR: Frame capture needs OpenGL 3.2 (or ARB_sync and ARB_map_buffer_range)!\n";
+        m_glFailed = true;
+        return false;
+    }
+    for (auto& slot : m_slots)
+        m_gl->GenBuffers(1, &slot.pbo);
+    m_glReady = true;
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+void FrameCapture::capture(sf::RenderTarget& target)
+{
+    if (!m_ok || m_glFailed || !target.setActive(true))
+        return;
+
+    sf::Clock timer;
+    if (!m_glReady && !initGL())
+        return;
+
+    collect(false);
+
+    // At most one frame per 1/fps
+    long long number = (long long)(m_clock.getElapsedTime().asSeconds() * (float)m_fps);
+    if (number > m_lastNumber)
+    {
+        if (m_pending == SLOTS) // The GPU is behind...
+        {
+            std::lock_guard lock(m_mutex);
+            ++m_stats.dropped;
+        }
+        else
+        {
+            Slot& slot = m_slots[m_next];
+            slot.size = target.getSize();
+            slot.flipped = !dynamic_cast<sf::RenderTexture*>(&target); // (SFML keeps those upside down.)
+            slot.number = number;
+            size_t bytes = (size_t)slot.size.x * slot.size.y * 4;
+
+            m_gl->BindBuffer(gl::PIXEL_PACK_BUFFER, slot.pbo);
+            if (slot.capacity < bytes)
+            {
+                m_gl->BufferData(gl::PIXEL_PACK_BUFFER, (std::ptrdiff_t)bytes, nullptr, gl::STREAM_READ);
+                slot.capacity = bytes;
+            }
+            // With a pack buffer bound, this only queues the copy
+            m_gl->ReadPixels(0, 0, (GLsizei)slot.size.x, (GLsizei)slot.size.y, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+            m_gl->BindBuffer(gl::PIXEL_PACK_BUFFER, 0);
+            slot.fence = m_gl->FenceSync(gl::SYNC_GPU_COMMANDS_COMPLETE, 0);
+            m_gl->Flush(); // So that the fence can signal even if waited for from another context
+
+            m_next = (m_next + 1) % SLOTS;
+            ++m_pending;
+            m_lastNumber = number;
+        }
+    }
+
+    std::lock_guard lock(m_mutex);
+    m_stats.overhead += timer.getElapsedTime();
+}
+
+
+void FrameCapture::collect(bool wait)
+{
+    while (m_pending)
+    {
+        Slot& slot = m_slots[(m_next + SLOTS - m_pending) % SLOTS];
+        GLenum status = m_gl->ClientWaitSync(slot.fence, wait ? gl::SYNC_FLUSH_COMMANDS_BIT : 0,
+                                             wait ? 1'000'000'000 : 0); // ns
+        bool done = status == gl::ALREADY_SIGNALED || status == gl::CONDITION_SATISFIED;
+        if (!done && !wait)
+            break; // Not yet (and the later ones can't be done either)
+
+        m_gl->DeleteSync(slot.fence);
+        slot.fence = nullptr;
+        --m_pending;
+
+        std::unique_ptr<Frame> frame;
+        {
+            std::lock_guard lock(m_mutex);
+            if (done && !m_free.empty())
+            {
+                frame = std::move(m_free.back());
+                m_free.pop_back();
+            }
+            else ++m_stats.dropped; // The encoder is behind (or the GPU has failed us)
+        }
+        if (!frame)
+            continue;
+
+        size_t rowBytes = (size_t)slot.size.x * 4;
+        frame->pixels.resize(rowBytes * slot.size.y);
+        frame->size = slot.size;
+        frame->number = slot.number;
+
+        m_gl->BindBuffer(gl::PIXEL_PACK_BUFFER, slot.pbo);
+        auto* data = (const std::uint8_t*)m_gl->MapBufferRange(gl::PIXEL_PACK_BUFFER, 0,
+                                                               (std::ptrdiff_t)frame->pixels.size(), gl::MAP_READ_BIT);
+        if (data)
+        {
+            for (size_t y = 0; y < slot.size.y; ++y)
+            {
+                size_t from = slot.flipped ? slot.size.y - 1 - y : y;
+                std::memcpy(frame->pixels.data() + y * rowBytes, data + from * rowBytes, rowBytes);
+            }
+            m_gl->UnmapBuffer(gl::PIXEL_PACK_BUFFER);
+        }
+        m_gl->BindBuffer(gl::PIXEL_PACK_BUFFER, 0);
+
+        {
+            std::lock_guard lock(m_mutex);
+            if (data)
+            {
+                m_queue.push_back(std::move(frame));
+                ++m_stats.captured;
+            }
+            else
+            {
+                m_free.push_back(std::move(frame));
+                ++m_stats.dropped;
+            }
+        }
+        m_wake.notify_one();
+    }
+}
+
+
+//----------------------------------------------------------------------------
+void FrameCapture::encoder()
+{
+    for (;;)
+    {
+        std::unique_ptr<Frame> frame;
+        {
+            std::unique_lock lock(m_mutex);
+            m_wake.wait(lock, [this] { return m_stop || !m_queue.empty(); });
+            if (m_queue.empty()) return; // Stopped (with nothing left to encode)
+            frame = std::move(m_queue.front());
+            m_queue.pop_front();
+        }
+
+        sf::Clock timer;
+        bool written = encode(*frame);
+
+        std::lock_guard lock(m_mutex);
+        ++(written ? m_stats.written : m_stats.dropped);
+        m_stats.encoding += timer.getElapsedTime();
+        m_free.push_back(std::move(frame));
+    }
+}
+
+
+bool FrameCapture::encode(Frame& frame)
+{
+    if (m_format == Format::Y4M)
+        return writeY4M(frame);
+
+    // The alpha of the framebuffer means nothing on screen
+    for (size_t i = 3; i < frame.pixels.size(); i += 4)
+        frame.pixels[i] = 255;
+
+    char name[32];
+    std::snprintf(name, sizeof name, "%06lld.png", frame.number);
+    sf::Image image;
+    image.create(frame.size, frame.pixels.data());
+    if (!image.saveToFile(m_path + name))
+    {
+        if (!m_writeFailed)
+            cerr << "- ERROR: Failed to write the captured frame \"" << m_path + name << "\"!\n";
+        m_writeFailed = true;
+        return false;
+    }
+    return true;
+}
+
+
+bool FrameCapture::writeY4M(const Frame& frame)
+{
+    unsigned w = frame.size.x, h = frame.size.y;
+    if (m_yuv.empty()) // The first frame: the header
+    {
+        m_streamSize = frame.size;
+        m_streamFrames = frame.number;
+        m_file << "YUV4MPEG2 W" << w << " H" << h << " F" << m_fps << ":1 Ip A1:1 C420jpeg\n";
+    }
+    else if (frame.size != m_streamSize)
+    {
+        if (!m_writeFailed)
+            cerr << "- Warning: The captured frames have been resized, which the Y4M stream can't follow, dropping them!\n";
+        m_writeFailed = true;
+        return false;
+    }
+
+    // Repeat the last frame for the time nothing has been rendered
+    for (; m_streamFrames < frame.number; ++m_streamFrames)
+    {
+        m_file << "FRAME\n";
+        m_file.write((const char*)m_yuv.data(), (std::streamsize)m_yuv.size());
+    }
+
+    // 4:2:0: the chroma planes are half the size (rounded up) both ways
+    unsigned cw = (w + 1) / 2, ch = (h + 1) / 2;
+    m_yuv.resize((size_t)w * h + 2 * (size_t)cw * ch);
+    std::uint8_t* Y = m_yuv.data();
+    std::uint8_t* U = Y + (size_t)w * h;
+    std::uint8_t* V = U + (size_t)cw * ch;
+    const std::uint8_t* px = frame.pixels.data();
+    for (unsigned y = 0; y < h; ++y)
+        for (unsigned x = 0; x < w; ++x)
+        {
+            const std::uint8_t* p = px + ((size_t)y * w + x) * 4;
+            Y[(size_t)y * w + x] = luma(p[0], p[1], p[2]);
+        }
+    for (unsigned y = 0; y < ch; ++y)
+        for (unsigned x = 0; x < cw; ++x)
+        {
+            // Average the (up to) 2x2 pixels
+            int r = 0, g = 0, b = 0, n = 0;
+            for (unsigned dy = 0; dy < 2 && 2 * y + dy < h; ++dy)
+                for (unsigned dx = 0; dx < 2 && 2 * x + dx < w; ++dx, ++n)
+                {
+                    const std::uint8_t* p = px + ((size_t)(2 * y + dy) * w + 2 * x + dx) * 4;
+                    r += p[0]; g += p[1]; b += p[2];
+                }
+            r /= n; g /= n; b /= n;
+            U[(size_t)y * cw + x] = cb(r, g, b);
+            V[(size_t)y * cw + x] = cr(r, g, b);
+        }
+
+    m_file << "FRAME\n";
+    m_file.write((const char*)m_yuv.data(), (std::streamsize)m_yuv.size());
+    ++m_streamFrames;
+
+    if (!m_file)
+    {
+        if (!m_writeFailed)
+            cerr << "- ERROR: Failed to write the capture file \"" << m_path << "\"!\n";
+        m_writeFailed = true;
+        return false;
+    }
+    return true;
+}
+
+} // namespace gfx
+} // namespace sfw
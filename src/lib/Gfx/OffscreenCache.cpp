@@ -0,0 +1,218 @@
+#include "sfw/Gfx/OffscreenCache.hpp"
+#include "sfw/util/alloc_guard.hpp"
+
+#include <SFML/Graphics/RenderTexture.hpp>
+#include <SFML/Graphics/Vertex.hpp>
+#include <SFML/Graphics/View.hpp>
+
+#include <cmath>
+    using std::ceil;
+#include <cstdlib>
+#include <algorithm>
+#include <vector>
+#include <mutex>
+
+namespace sfw
+{
+namespace gfx
+{
+
+struct OffscreenCache::Texture
+{
+    sf::RenderTexture texture;
+    Renderer renderer{texture};
+};
+
+namespace
+{
+    // The caches having a texture (in no particular order; the eviction
+    // looks for the least recently used one), and their total memory
+    // (Caches may come and go on any thread.)
+    std::mutex s_mutex;
+    std::vector<const OffscreenCache*> s_caches;
+    size_t s_memoryUsed = 0;
+    size_t s_memoryLimit = 64 * 1024 * 1024;
+    std::uint64_t s_frame = 1;
+} // namespace
+
+
+//============================================================================
+void OffscreenCache::setMemoryLimit(size_t bytes)
+{
+    std::lock_guard lock(s_mutex);
+    s_memoryLimit = bytes;
+}
+
+size_t OffscreenCache::getMemoryLimit()
+{
+    std::lock_guard lock(s_mutex);
+    return s_memoryLimit;
+}
+
+size_t OffscreenCache::getMemoryUsage()
+{
+    std::lock_guard lock(s_mutex);
+    return s_memoryUsed;
+}
+
+void OffscreenCache::nextFrame()
+{
+    std::lock_guard lock(s_mutex);
+    ++s_frame;
+}
+
+
+//----------------------------------------------------------------------------
+OffscreenCache::OffscreenCache() = default;
+
+OffscreenCache::~OffscreenCache()
+{
+    release();
+}
+
+OffscreenCache::OffscreenCache(OffscreenCache&& other) noexcept
+{
+    other.release();
+}
+
+OffscreenCache& OffscreenCache::operator=(OffscreenCache&& other) noexcept
+{
+    release();
+    other.release();
+    return *this;
+}
+
+
+void OffscreenCache::release() const
+{
+    std::lock_guard lock(s_mutex);
+    if (!m_texture)
+        return;
+    s_caches.erase(std::find(s_caches.begin(), s_caches.end(), this));
+    s_memoryUsed -= m_bytes;
+    m_bytes = 0;
+    m_texture.reset();
+    m_valid = false;
+}
+
+
+bool OffscreenCache::allocate(size_t bytes) const
+{
+    std::lock_guard lock(s_mutex);
+
+    // Drop the least recently used ones (but none drawn in this frame), while it doesn't fit
+    while (s_memoryUsed + bytes > s_memoryLimit)
+    {
+        auto lru = std::min_element(s_caches.begin(), s_caches.end(),
+            [](auto* a, auto* b) { return a->m_lastUse < b->m_lastUse; });
+        if (lru == s_caches.end() || (*lru)->m_lastUse >= s_frame)
+            return false;
+
+        const OffscreenCache* victim = *lru;
+        s_caches.erase(lru);
+        s_memoryUsed -= victim->m_bytes;
+        victim->m_bytes = 0;
+        victim->m_texture.reset(); // (Re-rendered when it's drawn next time.)
+        victim->m_valid = false;
+    }
+
+    AllocationGuard::Pause exempt; // Not a per-frame thing
+    s_caches.push_back(this);
+    s_memoryUsed += bytes;
+    m_bytes = bytes;
+    m_lastUse = s_frame;
+    return true;
+}
+
+
+OffscreenCache::State OffscreenCache::prepare(const RenderContext& ctx, const sf::RenderStates& states, sf::Vector2f size) const
+{
+    // Where the content would be drawn on the target, and how many pixels of
+    // the target that covers (so the cache has the resolution of the target
+    // at any zoom level, instead of that of the world)
+    sf::FloatRect area = states.transform.transformRect({{0, 0}, size});
+    const sf::View& view = ctx.target.getView();
+    sf::IntRect viewport = ctx.target.getViewport(view);
+    sf::Vector2f scale((float)viewport.width  / std::abs(view.getSize().x),
+                       (float)viewport.height / std::abs(view.getSize().y));
+    sf::Vector2u pixels((unsigned)ceil(area.width * scale.x), (unsigned)ceil(area.height * scale.y));
+    if (!pixels.x || !pixels.y) return State::Empty; // Nothing to draw, then...
+    // (The world area of the whole texture, i.e. with the pixels rounded up)
+    area.width  = (float)pixels.x / scale.x;
+    area.height = (float)pixels.y / scale.y;
+
+    // (Moving, or zooming, also changes the area.)
+    if (area != m_area) m_valid = false;
+
+    // (Re)create the texture if the size has changed
+    if (!m_texture || m_texture->texture.getSize() != pixels)
+    {
+        release();
+        if (!allocate((size_t)pixels.x * pixels.y * 4))
+            return State::Unusable;
+
+        AllocationGuard::Pause exempt; // Not a per-frame thing
+        auto texture = std::make_unique<Texture>();
+        if (!texture->texture.create(pixels))
+        {
+            std::lock_guard lock(s_mutex);
+            s_caches.erase(std::find(s_caches.begin(), s_caches.end(), this));
+            s_memoryUsed -= m_bytes;
+            m_bytes = 0;
+            return State::Unusable;
+        }
+        m_texture = std::move(texture);
+        m_valid = false;
+    }
+    else
+    {
+        std::lock_guard lock(s_mutex);
+        m_lastUse = s_frame;
+    }
+
+    m_area = area;
+    return m_valid ? State::Valid : State::Stale;
+}
+
+
+RenderContext OffscreenCache::beginRender(const sf::RenderStates& states) const
+{
+    m_valid = true;
+
+    // The content is drawn with the same transform as usual, just with the
+    // view moved to where it is (and scaled to the texture)
+    auto& [texture, renderer] = *m_texture;
+    texture.setView(sf::View(m_area));
+    texture.clear(sf::Color::Transparent);
+    renderer.begin();
+    return RenderContext{texture, states, renderer};
+}
+
+
+void OffscreenCache::endRender() const
+{
+    m_texture->renderer.end();
+    m_texture->texture.display();
+}
+
+
+void OffscreenCache::paste(const RenderContext& ctx) const
+{
+    // (The cache has been alpha-blended onto a transparent background, so its
+    // content is effectively alpha-premultiplied.)
+    sf::Vector2u pixels = m_texture->texture.getSize();
+    float w = (float)pixels.x, h = (float)pixels.y;
+    const sf::FloatRect& a = m_area;
+    const sf::Vertex quad[] = {
+        {{a.left,           a.top},            {0, 0}},
+        {{a.left,           a.top + a.height}, {0, h}},
+        {{a.left + a.width, a.top},            {w, 0}},
+        {{a.left + a.width, a.top + a.height}, {w, h}},
+    };
+    sf::RenderStates states(&m_texture->texture.getTexture());
+    states.blendMode = sf::BlendMode(sf::BlendMode::Factor::One, sf::BlendMode::Factor::OneMinusSrcAlpha);
+    ctx.renderer.draw(quad, 4, sf::PrimitiveType::TriangleStrip, states);
+}
+
+} // namespace gfx
+} // namespace sfw
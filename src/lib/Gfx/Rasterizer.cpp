@@ -0,0 +1,345 @@
+#include "sfw/Gfx/Rasterizer.hpp"
+#include "sfw/Gfx/SdfFont.hpp"
+#include "sfw/Theme.hpp"
+
+#include <algorithm>
+    using std::min, std::max;
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+# define SFW_RASTERIZER_SSE2
+# include <emmintrin.h>
+#endif
+
+namespace sfw
+{
+namespace gfx
+{
+
+namespace
+{
+    // x / 255, rounded (exact for x <= 255 * 255)
+    inline unsigned div255(unsigned x)
+    {
+        x += 128;
+        return (x + (x >> 8)) >> 8;
+    }
+
+    inline std::uint32_t pack(std::uint8_t r, std::uint8_t g, std::uint8_t b, std::uint8_t a)
+    {
+        const std::uint8_t bytes[4] = {r, g, b, a};
+        std::uint32_t pixel;
+        std::memcpy(&pixel, bytes, 4);
+        return pixel;
+    }
+
+    // sf::BlendAlpha, for one pixel (the SIMD path must give the same results!)
+    inline void blendPixel(std::uint8_t* d, const std::uint8_t* s)
+    {
+        unsigned a = s[3], ia = 255 - a;
+        d[0] = (std::uint8_t)div255(s[0] * a + d[0] * ia);
+        d[1] = (std::uint8_t)div255(s[1] * a + d[1] * ia);
+        d[2] = (std::uint8_t)div255(s[2] * a + d[2] * ia);
+        d[3] = (std::uint8_t)div255(a * 255 + d[3] * ia);
+    }
+
+#ifdef SFW_RASTERIZER_SSE2
+    inline __m128i div255_epu16(__m128i x)
+    {
+        x = _mm_add_epi16(x, _mm_set1_epi16(128));
+        return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+    }
+
+    // Two pixels, unpacked to 16 bits per channel
+    // (No overflow: the weights of each channel add up to 255.)
+    inline __m128i blend2(__m128i s, __m128i d)
+    {
+        const __m128i alphaLanes = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+        __m128i a  = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+        __m128i sf = _mm_or_si128(_mm_andnot_si128(alphaLanes, a), _mm_and_si128(alphaLanes, _mm_set1_epi16(255)));
+        __m128i df = _mm_sub_epi16(_mm_set1_epi16(255), a);
+        return div255_epu16(_mm_add_epi16(_mm_mullo_epi16(s, sf), _mm_mullo_epi16(d, df)));
+    }
+#endif
+} // namespace
+
+
+//============================================================================
+Rasterizer::Rasterizer(sf::Vector2u size):
+    m_size(size),
+    m_pixels((size_t)size.x * size.y, 0),
+    m_span(size.x),
+    m_target(size),
+    m_renderer(m_target)
+{
+    m_renderer.setRecordOnly(true);
+    m_renderer.setTextMode(Renderer::TextMode::Sdf); // No glyph pages to read back (see draw())
+}
+
+
+void Rasterizer::clear(sf::Color color)
+{
+    std::fill(m_pixels.begin(), m_pixels.end(), pack(color.r, color.g, color.b, color.a));
+}
+
+
+void Rasterizer::render(const Drawable& object, const sf::RenderStates& states)
+{
+    m_readback.clear(); // The textures may have changed since the last time
+    m_renderer.render(object, states);
+    draw(m_renderer.drawList());
+}
+
+
+void Rasterizer::setTextureImage(const sf::Texture& texture, const sf::Image& image)
+{
+    m_textureImages[&texture] = &image;
+}
+
+
+sf::Image Rasterizer::toImage() const
+{
+    sf::Image image;
+    image.create(m_size, getPixels());
+    return image;
+}
+
+
+const sf::Image* Rasterizer::imageOf(const sf::Texture* texture)
+{
+    if (texture == &Theme::getTexture())
+        return &Theme::getTextureImage();
+
+    if (auto it = m_textureImages.find(texture); it != m_textureImages.end())
+        return it->second;
+
+    // Read it back from the GPU, then (empty, if that's not possible)
+    auto [it, added] = m_readback.try_emplace(texture);
+    if (added)
+        it->second = texture->copyToImage();
+    return it->second.getSize().x ? &it->second : nullptr;
+}
+
+
+//----------------------------------------------------------------------------
+void Rasterizer::draw(const DrawList& list)
+{
+    const sf::IntRect bounds({0, 0}, {(int)m_size.x, (int)m_size.y});
+    const sf::IntRect vp = m_target.getViewport(list.view);
+
+    for (const auto& cmd : list.commands())
+    {
+        // SDF text (the shader's work is done by fillTriangle())
+        const SdfFont* sdf = cmd.states.texture ? SdfFont::ofTexture(cmd.states.texture) : nullptr;
+
+        if ((cmd.states.shader && !sdf)
+            || (cmd.type != sf::PrimitiveType::Triangles
+             && cmd.type != sf::PrimitiveType::TriangleStrip
+             && cmd.type != sf::PrimitiveType::TriangleFan))
+            continue;
+
+        Source source;
+        if (sdf)
+        {
+            source = {sdf->getPixels().data(), (int)sdf->getSize().x, (int)sdf->getSize().y, true};
+        }
+        else if (cmd.states.texture)
+        {
+            const sf::Image* image = imageOf(cmd.states.texture);
+            if (!image)
+                continue;
+            source = {image->getPixelsPtr(), (int)image->getSize().x, (int)image->getSize().y};
+        }
+
+        auto clip = bounds.findIntersection(cmd.clip);
+        if (!clip)
+            continue;
+
+        Blend mode = cmd.states.blendMode == sf::BlendNone ? Blend::None
+                   : cmd.states.blendMode == sf::BlendMode(sf::BlendMode::Factor::One, sf::BlendMode::Factor::OneMinusSrcAlpha)
+                                                            ? Blend::Premultiplied
+                   : Blend::Alpha;
+
+        // World -> normalized device coords. -> pixels (like the GPU would)
+        sf::Transform toNdc = list.view.getTransform() * cmd.states.transform;
+        auto map = [&](const sf::Vertex& v) -> Vertex {
+            sf::Vector2f p = toNdc.transformPoint(v.position);
+            return {(float)vp.left + (p.x + 1) / 2 * (float)vp.width,
+                    (float)vp.top  + (1 - p.y) / 2 * (float)vp.height,
+                    v.color, v.texCoords.x, v.texCoords.y};
+        };
+
+        const sf::Vertex* v = list.vertices().data() + cmd.first;
+        switch (cmd.type)
+        {
+        case sf::PrimitiveType::Triangles:
+            for (size_t i = 2; i < cmd.count; i += 3)
+                fillTriangle(map(v[i - 2]), map(v[i - 1]), map(v[i]), source, *clip, mode);
+            break;
+        case sf::PrimitiveType::TriangleStrip:
+            for (size_t i = 2; i < cmd.count; ++i)
+                fillTriangle(map(v[i - 2]), map(v[i - 1]), map(v[i]), source, *clip, mode);
+            break;
+        case sf::PrimitiveType::TriangleFan:
+            for (size_t i = 2; i < cmd.count; ++i)
+                fillTriangle(map(v[0]), map(v[i - 1]), map(v[i]), source, *clip, mode);
+            break;
+        default:; // Can't get here.
+        }
+    }
+}
+
+
+void Rasterizer::fillTriangle(Vertex a, Vertex b, Vertex c, const Source& source, const sf::IntRect& clip, Blend mode)
+{
+    float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+    if (area == 0)
+        return;
+    if (area < 0) // Make it positive inside
+    {
+        std::swap(b, c);
+        area = -area;
+    }
+
+    int x0 = max(clip.left,               (int)std::floor(min({a.x, b.x, c.x})));
+    int x1 = min(clip.left + clip.width,  (int)std::ceil (max({a.x, b.x, c.x})));
+    int y0 = max(clip.top,                (int)std::floor(min({a.y, b.y, c.y})));
+    int y1 = min(clip.top  + clip.height, (int)std::ceil (max({a.y, b.y, c.y})));
+    if (x0 >= x1 || y0 >= y1)
+        return;
+
+    // Edge functions (positive inside); pixels exactly on an edge are only
+    // taken on "top-left" edges, so that they're not drawn by both triangles
+    // sharing that edge
+    struct Edge
+    {
+        float px, py, dx, dy;
+        bool inclusive;
+        Edge(const Vertex& p, const Vertex& q) : px(p.x), py(p.y), dx(q.x - p.x), dy(q.y - p.y),
+                                                 inclusive(dy < 0 || (dy == 0 && dx > 0)) {}
+        float at(float x, float y) const { return dx * (y - py) - dy * (x - px); }
+        static bool inside(float e, bool inclusive) { return e > 0 || (e == 0 && inclusive); }
+    };
+    const Edge ab(a, b), bc(b, c), ca(c, a);
+
+    bool solid = a.color == b.color && b.color == c.color;
+    const std::uint8_t* texels = source.texels;
+    int tw = source.width, th = source.height;
+
+    // For distance fields: the smoothing width of the SDF shader (which is
+    // 0.7 * fwidth(distance)), from the texels per pixel of the triangle
+    float sdfWidth = 0;
+    if (source.sdf)
+    {
+        float uvArea = std::abs((b.u - a.u) * (c.v - a.v) - (b.v - a.v) * (c.u - a.u));
+        float texelsPerPixel = std::sqrt(uvArea / area);
+        sdfWidth = max(0.7f * texelsPerPixel / (2 * (float)SdfFont::SPREAD), 0.0001f);
+    }
+
+    for (int y = y0; y < y1; ++y)
+    {
+        float cy = (float)y + 0.5f;
+        size_t n = 0;
+        int start = x1;
+        for (int x = x0; x < x1; ++x)
+        {
+            float cx = (float)x + 0.5f;
+            float ea = bc.at(cx, cy), eb = ca.at(cx, cy), ec = ab.at(cx, cy);
+            if (!Edge::inside(ea, bc.inclusive) || !Edge::inside(eb, ca.inclusive) || !Edge::inside(ec, ab.inclusive))
+            {
+                if (n) break; // Convex: past the span already
+                continue;
+            }
+            if (!n) start = x;
+
+            // Barycentric weights
+            float la = ea / area, lb = eb / area, lc = ec / area;
+
+            sf::Color color = a.color;
+            if (!solid)
+            {
+                auto mix = [&](std::uint8_t ca_, std::uint8_t cb_, std::uint8_t cc_) {
+                    return (std::uint8_t)std::clamp(la * ca_ + lb * cb_ + lc * cc_ + 0.5f, 0.f, 255.f);
+                };
+                color = {mix(a.color.r, b.color.r, c.color.r), mix(a.color.g, b.color.g, c.color.g),
+                         mix(a.color.b, b.color.b, c.color.b), mix(a.color.a, b.color.a, c.color.a)};
+            }
+            if (texels && source.sdf)
+            {
+                // Bilinear, as the atlas texture is smooth
+                float fu = la * a.u + lb * b.u + lc * c.u - 0.5f;
+                float fv = la * a.v + lb * b.v + lc * c.v - 0.5f;
+                int u0 = (int)std::floor(fu), v0 = (int)std::floor(fv);
+                float wu = fu - (float)u0, wv = fv - (float)v0;
+                auto at = [&](int u, int v) {
+                    return (float)texels[((size_t)std::clamp(v, 0, th - 1) * tw + (size_t)std::clamp(u, 0, tw - 1)) * 4 + 3] / 255.f;
+                };
+                float distance = (at(u0, v0)     * (1 - wu) + at(u0 + 1, v0)     * wu) * (1 - wv)
+                               + (at(u0, v0 + 1) * (1 - wu) + at(u0 + 1, v0 + 1) * wu) * wv;
+                float t = std::clamp((distance - (0.5f - sdfWidth)) / (2 * sdfWidth), 0.f, 1.f);
+                float coverage = t * t * (3 - 2 * t); // smoothstep()
+                color.a = (std::uint8_t)std::lround((float)color.a * coverage);
+            }
+            else if (texels)
+            {
+                int u = std::clamp((int)std::floor(la * a.u + lb * b.u + lc * c.u), 0, tw - 1);
+                int v = std::clamp((int)std::floor(la * a.v + lb * b.v + lc * c.v), 0, th - 1);
+                const std::uint8_t* t = texels + ((size_t)v * tw + u) * 4;
+                color = {(std::uint8_t)div255(color.r * t[0]), (std::uint8_t)div255(color.g * t[1]),
+                         (std::uint8_t)div255(color.b * t[2]), (std::uint8_t)div255(color.a * t[3])};
+            }
+            m_span[n++] = pack(color.r, color.g, color.b, color.a);
+        }
+        if (n)
+            blend(m_pixels.data() + (size_t)y * m_size.x + start, m_span.data(), n, mode);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+void Rasterizer::blend(std::uint32_t* dst, const std::uint32_t* src, size_t count, Blend mode)
+{
+    switch (mode)
+    {
+    case Blend::Alpha:
+        blendSpan(dst, src, count);
+        break;
+    case Blend::None:
+        std::memcpy(dst, src, count * sizeof *dst);
+        break;
+    case Blend::Premultiplied:
+        for (size_t i = 0; i < count; ++i)
+        {
+            auto* d = (std::uint8_t*)(dst + i);
+            auto* s = (const std::uint8_t*)(src + i);
+            unsigned ia = 255 - s[3];
+            for (int ch = 0; ch < 4; ++ch)
+                d[ch] = (std::uint8_t)min(255u, s[ch] + div255(d[ch] * ia));
+        }
+        break;
+    }
+}
+
+
+void Rasterizer::blendSpan(std::uint32_t* dst, const std::uint32_t* src, size_t count)
+{
+    size_t i = 0;
+#ifdef SFW_RASTERIZER_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+        __m128i lo = blend2(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero));
+        __m128i hi = blend2(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(lo, hi));
+    }
+#endif
+    for (; i < count; ++i)
+        blendPixel((std::uint8_t*)(dst + i), (const std::uint8_t*)(src + i));
+}
+
+} // namespace gfx
+} // namespace sfw
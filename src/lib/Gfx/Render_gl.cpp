@@ -0,0 +1,508 @@
+#include "sfw/Gfx/Render.hpp"
+
+#ifdef SFW_CFG_GFX_USE_OPENGL
+
+#include "sfw/Gfx/Render_gl.hpp"
+
+#include <SFML/Window/Context.hpp>
+#include <SFML/Graphics/Texture.hpp>
+#include <SFML/OpenGL.hpp>
+
+#include "sfw/util/alloc_guard.hpp"
+
+#include <algorithm>
+    using std::max;
+#include <mutex>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
+#include <iostream>
+    using std::cerr;
+
+#ifndef APIENTRY
+#define APIENTRY
+#endif
+
+namespace sfw
+{
+namespace gfx
+{
+
+namespace
+{
+    // Not all the GL headers around have these (most only do GL 1.1):
+    namespace gl
+    {
+        constexpr GLenum ARRAY_BUFFER         = 0x8892;
+        constexpr GLenum STREAM_DRAW          = 0x88E0;
+        constexpr GLenum FRAGMENT_SHADER      = 0x8B30;
+        constexpr GLenum VERTEX_SHADER        = 0x8B31;
+        constexpr GLenum COMPILE_STATUS       = 0x8B81;
+        constexpr GLenum LINK_STATUS          = 0x8B82;
+        constexpr GLenum TEXTURE0             = 0x84C0;
+        constexpr GLenum FUNC_ADD             = 0x8006;
+        constexpr GLenum MAJOR_VERSION        = 0x821B;
+        constexpr GLenum MINOR_VERSION        = 0x821C;
+        constexpr GLenum SYNC_GPU_COMMANDS_COMPLETE = 0x9117;
+        constexpr GLenum ALREADY_SIGNALED     = 0x911A;
+        constexpr GLenum CONDITION_SATISFIED  = 0x911C;
+        constexpr GLenum WAIT_FAILED          = 0x911D;
+        constexpr GLbitfield SYNC_FLUSH_COMMANDS_BIT = 0x0001;
+        constexpr GLbitfield MAP_WRITE_BIT      = 0x0002;
+        constexpr GLbitfield MAP_PERSISTENT_BIT = 0x0040;
+        constexpr GLbitfield MAP_COHERENT_BIT   = 0x0080;
+    }
+
+    constexpr size_t MIN_BUFFER_SIZE = 256 * 1024; // bytes (per region)
+
+    const char* VERTEX_SHADER = R"(#version 330
+layout(location = 0) in vec2 position;
+layout(location = 1) in vec4 color;
+layout(location = 2) in vec2 texCoords;
+uniform mat4 projection;
+uniform vec2 texScale; // Pixels -> normalized tex. coords
+out vec4 vColor;
+out vec2 vTexCoords;
+void main()
+{
+    gl_Position = projection * vec4(position, 0.0, 1.0);
+    vColor = color;
+    vTexCoords = texCoords * texScale;
+}
+)";
+
+    const char* FRAGMENT_SHADER = R"(#version 330
+uniform sampler2D tex;
+uniform bool textured;
+in vec4 vColor;
+in vec2 vTexCoords;
+out vec4 fragColor;
+void main()
+{
+    fragColor = textured ? vColor * texture(tex, vTexCoords) : vColor;
+}
+)";
+
+    GLenum primitive(sf::PrimitiveType type)
+    {
+        switch (type)
+        {
+        case sf::PrimitiveType::Points:        return GL_POINTS;
+        case sf::PrimitiveType::Lines:         return GL_LINES;
+        case sf::PrimitiveType::LineStrip:     return GL_LINE_STRIP;
+        case sf::PrimitiveType::TriangleStrip: return GL_TRIANGLE_STRIP;
+        case sf::PrimitiveType::TriangleFan:   return GL_TRIANGLE_FAN;
+        default:                               return GL_TRIANGLES;
+        }
+    }
+} // namespace
+
+
+//----------------------------------------------------------------------------
+struct GLBackend::Functions
+{
+    // GL 1.1 (loaded, too, so there's nothing to link against)
+    void      (APIENTRY* Enable)(GLenum);
+    void      (APIENTRY* Disable)(GLenum);
+    void      (APIENTRY* Viewport)(GLint, GLint, GLsizei, GLsizei);
+    void      (APIENTRY* Scissor)(GLint, GLint, GLsizei, GLsizei);
+    void      (APIENTRY* BindTexture)(GLenum, GLuint);
+    void      (APIENTRY* DrawArrays)(GLenum, GLint, GLsizei);
+    void      (APIENTRY* GetIntegerv)(GLenum, GLint*);
+    // GL 1.3 - 3.3
+    void      (APIENTRY* ActiveTexture)(GLenum);
+    void      (APIENTRY* BlendFuncSeparate)(GLenum, GLenum, GLenum, GLenum);
+    void      (APIENTRY* BlendEquation)(GLenum);
+    void      (APIENTRY* GenBuffers)(GLsizei, GLuint*);
+    void      (APIENTRY* DeleteBuffers)(GLsizei, const GLuint*);
+    void      (APIENTRY* BindBuffer)(GLenum, GLuint);
+    void      (APIENTRY* BufferData)(GLenum, std::ptrdiff_t, const void*, GLenum);
+    void      (APIENTRY* BufferSubData)(GLenum, std::ptrdiff_t, std::ptrdiff_t, const void*);
+    void      (APIENTRY* GenVertexArrays)(GLsizei, GLuint*);
+    void      (APIENTRY* BindVertexArray)(GLuint);
+    void      (APIENTRY* EnableVertexAttribArray)(GLuint);
+    void      (APIENTRY* VertexAttribPointer)(GLuint, GLint, GLenum, GLboolean, GLsizei, const void*);
+    GLuint    (APIENTRY* CreateShader)(GLenum);
+    void      (APIENTRY* ShaderSource)(GLuint, GLsizei, const char* const*, const GLint*);
+    void      (APIENTRY* CompileShader)(GLuint);
+    void      (APIENTRY* GetShaderiv)(GLuint, GLenum, GLint*);
+    void      (APIENTRY* DeleteShader)(GLuint);
+    GLuint    (APIENTRY* CreateProgram)();
+    void      (APIENTRY* AttachShader)(GLuint, GLuint);
+    void      (APIENTRY* LinkProgram)(GLuint);
+    void      (APIENTRY* GetProgramiv)(GLuint, GLenum, GLint*);
+    void      (APIENTRY* DeleteProgram)(GLuint);
+    void      (APIENTRY* UseProgram)(GLuint);
+    GLint     (APIENTRY* GetUniformLocation)(GLuint, const char*);
+    void      (APIENTRY* Uniform1i)(GLint, GLint);
+    void      (APIENTRY* Uniform2f)(GLint, GLfloat, GLfloat);
+    void      (APIENTRY* UniformMatrix4fv)(GLint, GLsizei, GLboolean, const GLfloat*);
+    void*     (APIENTRY* FenceSync)(GLenum, GLbitfield);
+    GLenum    (APIENTRY* ClientWaitSync)(void*, GLbitfield, std::uint64_t);
+    void      (APIENTRY* DeleteSync)(void*);
+    // GL 4.4 / ARB_buffer_storage (optional)
+    void      (APIENTRY* BufferStorage)(GLenum, std::ptrdiff_t, const void*, GLbitfield);
+    void*     (APIENTRY* MapBufferRange)(GLenum, std::ptrdiff_t, std::ptrdiff_t, GLbitfield);
+    GLboolean (APIENTRY* UnmapBuffer)(GLenum);
+
+    bool load()
+    {
+        bool ok = true;
+        auto get = [&ok](auto& fn, const char* name, bool required = true) {
+            fn = reinterpret_cast<std::remove_reference_t<decltype(fn)>>(sf::Context::getFunction(name));
+            if (!fn && required) ok = false;
+        };
+        get(Enable, "glEnable");             get(Disable, "glDisable");
+        get(Viewport, "glViewport");         get(Scissor, "glScissor");
+        get(BindTexture, "glBindTexture");   get(DrawArrays, "glDrawArrays");
+        get(GetIntegerv, "glGetIntegerv");
+        get(ActiveTexture, "glActiveTexture");
+        get(BlendFuncSeparate, "glBlendFuncSeparate");
+        get(BlendEquation, "glBlendEquation");
+        get(GenBuffers, "glGenBuffers");     get(DeleteBuffers, "glDeleteBuffers");
+        get(BindBuffer, "glBindBuffer");     get(BufferData, "glBufferData");
+        get(BufferSubData, "glBufferSubData");
+        get(GenVertexArrays, "glGenVertexArrays");
+        get(BindVertexArray, "glBindVertexArray");
+        get(EnableVertexAttribArray, "glEnableVertexAttribArray");
+        get(VertexAttribPointer, "glVertexAttribPointer");
+        get(CreateShader, "glCreateShader"); get(ShaderSource, "glShaderSource");
+        get(CompileShader, "glCompileShader"); get(GetShaderiv, "glGetShaderiv");
+        get(DeleteShader, "glDeleteShader");
+        get(CreateProgram, "glCreateProgram"); get(AttachShader, "glAttachShader");
+        get(LinkProgram, "glLinkProgram");   get(GetProgramiv, "glGetProgramiv");
+        get(DeleteProgram, "glDeleteProgram"); get(UseProgram, "glUseProgram");
+        get(GetUniformLocation, "glGetUniformLocation");
+        get(Uniform1i, "glUniform1i");       get(Uniform2f, "glUniform2f");
+        get(UniformMatrix4fv, "glUniformMatrix4fv");
+        get(FenceSync, "glFenceSync");       get(ClientWaitSync, "glClientWaitSync");
+        get(DeleteSync, "glDeleteSync");
+        get(BufferStorage, "glBufferStorage", false);
+        get(MapBufferRange, "glMapBufferRange", false);
+        get(UnmapBuffer, "glUnmapBuffer", false);
+        return ok;
+    }
+};
+
+
+//============================================================================
+std::shared_ptr<GLBackend> GLBackend::shared()
+{
+    static std::mutex mutex; // (E.g. a render thread may also be submitting.)
+    static std::weak_ptr<GLBackend> instance;
+
+    std::lock_guard lock(mutex);
+    auto backend = instance.lock();
+    if (!backend)
+    {
+        backend.reset(new GLBackend);
+        instance = backend;
+    }
+    return backend;
+}
+
+
+GLBackend::GLBackend():
+    m_gl(std::make_unique<Functions>())
+{
+    if (!init())
+    {
+        cerr << "- Warning: OpenGL 3.3 is not available, falling back to drawing via SFML!\n";
+        if (m_program) m_gl->DeleteProgram(m_program);
+        m_program = 0;
+    }
+}
+
+
+GLBackend::~GLBackend()
+{
+    if (!m_program)
+        return;
+
+    // The contexts of the renderers may be gone by now (the objects are
+    // shared; and the VAOs of the other contexts can't be deleted from here)
+    sf::Context context;
+    for (auto& fence : m_fences)
+        if (fence) m_gl->DeleteSync(fence);
+    if (m_mapped)
+    {
+        m_gl->BindBuffer(gl::ARRAY_BUFFER, m_vbo);
+        m_gl->UnmapBuffer(gl::ARRAY_BUFFER);
+        m_gl->BindBuffer(gl::ARRAY_BUFFER, 0);
+    }
+    m_gl->DeleteBuffers(1, &m_vbo);
+    m_gl->DeleteProgram(m_program);
+}
+
+
+bool GLBackend::init()
+{
+    if (!m_gl->load())
+        return false;
+
+    GLint major = 0, minor = 0;
+    m_gl->GetIntegerv(gl::MAJOR_VERSION, &major);
+    m_gl->GetIntegerv(gl::MINOR_VERSION, &minor);
+    if (major * 10 + minor < 33)
+        return false;
+
+    // The shader
+    auto compile = [this](GLenum type, const char* source) -> GLuint {
+        GLuint shader = m_gl->CreateShader(type);
+        m_gl->ShaderSource(shader, 1, &source, nullptr);
+        m_gl->CompileShader(shader);
+        GLint ok = GL_FALSE;
+        m_gl->GetShaderiv(shader, gl::COMPILE_STATUS, &ok);
+        if (!ok) { m_gl->DeleteShader(shader); return 0; }
+        return shader;
+    };
+    GLuint vs = compile(gl::VERTEX_SHADER, VERTEX_SHADER);
+    GLuint fs = compile(gl::FRAGMENT_SHADER, FRAGMENT_SHADER);
+    if (!vs || !fs)
+    {
+        if (vs) m_gl->DeleteShader(vs);
+        if (fs) m_gl->DeleteShader(fs);
+        return false;
+    }
+    m_program = m_gl->CreateProgram();
+    m_gl->AttachShader(m_program, vs);
+    m_gl->AttachShader(m_program, fs);
+    m_gl->LinkProgram(m_program);
+    m_gl->DeleteShader(vs); // (Only flagged for deletion while still attached.)
+    m_gl->DeleteShader(fs);
+    GLint linked = GL_FALSE;
+    m_gl->GetProgramiv(m_program, gl::LINK_STATUS, &linked);
+    if (!linked)
+        return false;
+
+    m_uProjection = m_gl->GetUniformLocation(m_program, "projection");
+    m_uTexScale   = m_gl->GetUniformLocation(m_program, "texScale");
+    m_uTextured   = m_gl->GetUniformLocation(m_program, "textured");
+    m_gl->UseProgram(m_program);
+    m_gl->Uniform1i(m_gl->GetUniformLocation(m_program, "tex"), 0);
+    m_gl->Uniform1i(m_uTextured, 0);
+    m_gl->UseProgram(0);
+
+    // The vertex buffer
+    m_persistent = m_gl->BufferStorage && m_gl->MapBufferRange && m_gl->UnmapBuffer
+                   && sf::Context::isExtensionAvailable("GL_ARB_buffer_storage");
+    grow(MIN_BUFFER_SIZE);
+    return true;
+}
+
+
+bool GLBackend::canDraw(const DrawList::Command& cmd)
+{
+    return !cmd.states.shader
+        && cmd.states.blendMode == sf::BlendAlpha
+        && cmd.states.transform == sf::Transform::Identity;
+}
+
+
+//----------------------------------------------------------------------------
+void GLBackend::grow(size_t bytes)
+{
+    if (m_vbo && bytes <= m_regionSize)
+        return;
+
+    // Round up to whole vertices, so the regions can be indexed by vertex
+    size_t size = max({bytes, m_regionSize * 2, MIN_BUFFER_SIZE});
+    size = (size + sizeof(sf::Vertex) - 1) / sizeof(sf::Vertex) * sizeof(sf::Vertex);
+
+    if (m_vbo)
+    {
+        // The old one can go right away: GL keeps it until the GPU is done with it
+        for (auto& fence : m_fences)
+            if (fence) { m_gl->DeleteSync(fence); fence = nullptr; }
+        if (m_mapped)
+        {
+            m_gl->BindBuffer(gl::ARRAY_BUFFER, m_vbo);
+            m_gl->UnmapBuffer(gl::ARRAY_BUFFER);
+            m_mapped = nullptr;
+        }
+        m_gl->DeleteBuffers(1, &m_vbo);
+    }
+
+    GLuint vbo = 0;
+    m_gl->GenBuffers(1, &vbo);
+    m_vbo = vbo;
+    ++m_buffer;
+    m_regionSize = size;
+    m_region = 0;
+    m_gl->BindBuffer(gl::ARRAY_BUFFER, m_vbo);
+    if (m_persistent)
+    {
+        GLbitfield flags = gl::MAP_WRITE_BIT | gl::MAP_PERSISTENT_BIT | gl::MAP_COHERENT_BIT;
+        m_gl->BufferStorage(gl::ARRAY_BUFFER, (std::ptrdiff_t)(size * REGIONS), nullptr, flags);
+        m_mapped = m_gl->MapBufferRange(gl::ARRAY_BUFFER, 0, (std::ptrdiff_t)(size * REGIONS), flags);
+        if (!m_mapped) // Oh, well...
+        {
+            m_persistent = false;
+            m_gl->DeleteBuffers(1, &m_vbo);
+            m_gl->GenBuffers(1, &vbo);
+            m_vbo = vbo;
+            m_gl->BindBuffer(gl::ARRAY_BUFFER, m_vbo);
+        }
+    }
+    if (!m_persistent)
+        m_gl->BufferData(gl::ARRAY_BUFFER, (std::ptrdiff_t)size, nullptr, gl::STREAM_DRAW);
+    m_gl->BindBuffer(gl::ARRAY_BUFFER, 0);
+}
+
+
+int GLBackend::upload(const void* vertices, size_t bytes)
+{
+    grow(bytes);
+
+    if (m_persistent)
+    {
+        // Take the next region, when the GPU has finished drawing from it
+        m_region = (m_region + 1) % REGIONS;
+        if (auto& fence = m_fences[m_region]; fence)
+        {
+            for (;;)
+            {
+                GLenum result = m_gl->ClientWaitSync(fence, gl::SYNC_FLUSH_COMMANDS_BIT, 1'000'000'000);
+                if (result == gl::ALREADY_SIGNALED || result == gl::CONDITION_SATISFIED || result == gl::WAIT_FAILED)
+                    break;
+            }
+            m_gl->DeleteSync(fence);
+            fence = nullptr;
+        }
+        std::memcpy((char*)m_mapped + m_region * m_regionSize, vertices, bytes);
+        return (int)(m_region * m_regionSize / sizeof(sf::Vertex));
+    }
+    else
+    {
+        // Orphan the previous content (so there's no waiting for the GPU to
+        // finish with it), and refill
+        m_gl->BindBuffer(gl::ARRAY_BUFFER, m_vbo);
+        m_gl->BufferData(gl::ARRAY_BUFFER, (std::ptrdiff_t)m_regionSize, nullptr, gl::STREAM_DRAW);
+        m_gl->BufferSubData(gl::ARRAY_BUFFER, 0, (std::ptrdiff_t)bytes, vertices);
+        return 0;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+void GLBackend::bindVertexArray()
+{
+    std::uint64_t context = sf::Context::getActiveContextId();
+    auto it = std::find_if(m_vertexArrays.begin(), m_vertexArrays.end(),
+                           [context](const VertexArray& va) { return va.context == context; });
+    if (it == m_vertexArrays.end())
+    {
+        GLuint vao = 0;
+        m_gl->GenVertexArrays(1, &vao);
+        AllocationGuard::Pause exempt; // Once per context
+        it = m_vertexArrays.insert(m_vertexArrays.end(), {context, vao, 0});
+    }
+    m_gl->BindVertexArray(it->vao);
+
+    // (Re)point it to the buffer, if that's new to it (i.e. it has grown)
+    if (it->buffer != m_buffer)
+    {
+        m_gl->BindBuffer(gl::ARRAY_BUFFER, m_vbo);
+        m_gl->EnableVertexAttribArray(0);
+        m_gl->EnableVertexAttribArray(1);
+        m_gl->EnableVertexAttribArray(2);
+        m_gl->VertexAttribPointer(0, 2, GL_FLOAT,         GL_FALSE, sizeof(sf::Vertex), (const void*)offsetof(sf::Vertex, position));
+        m_gl->VertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE,  sizeof(sf::Vertex), (const void*)offsetof(sf::Vertex, color));
+        m_gl->VertexAttribPointer(2, 2, GL_FLOAT,         GL_FALSE, sizeof(sf::Vertex), (const void*)offsetof(sf::Vertex, texCoords));
+        it->buffer = m_buffer;
+    }
+}
+
+
+size_t GLBackend::submit(sf::RenderTarget& target, const DrawList& list, size_t from, Renderer::Stats& stats)
+{
+    const auto& commands = list.commands();
+    size_t end = from;
+    while (end < commands.size() && canDraw(commands[end]))
+        ++end;
+    if (end == from || !target.setActive(true))
+        return from;
+
+    // The vertices of the run are contiguous in the list:
+    size_t firstVertex = commands[from].first;
+    size_t vertexCount = commands[end - 1].first + commands[end - 1].count - firstVertex;
+    int base = upload(list.vertices().data() + firstVertex, vertexCount * sizeof(sf::Vertex));
+
+    bindVertexArray();
+    m_gl->UseProgram(m_program);
+
+    // The view, the same way as SFML would set it up
+    GLint height = (GLint)target.getSize().y;
+    sf::IntRect vp = target.getViewport(list.view);
+    m_gl->Viewport(vp.left, height - (vp.top + vp.height), vp.width, vp.height);
+    const float* matrix = list.view.getTransform().getMatrix();
+    if (std::memcmp(matrix, m_projection, sizeof m_projection) != 0)
+    {
+        std::memcpy(m_projection, matrix, sizeof m_projection);
+        m_gl->UniformMatrix4fv(m_uProjection, 1, GL_FALSE, m_projection);
+    }
+
+    // sf::BlendAlpha
+    m_gl->Enable(GL_BLEND);
+    m_gl->BlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    m_gl->BlendEquation(gl::FUNC_ADD);
+    m_gl->Enable(GL_SCISSOR_TEST);
+    m_gl->ActiveTexture(gl::TEXTURE0);
+
+    // (SFML may have changed these since our last run:)
+    sf::IntRect scissor{{-1, -1}, {-1, -1}};
+    GLuint boundTexture = (GLuint)-1;
+
+    for (size_t i = from; i < end; ++i)
+    {
+        const auto& cmd = commands[i];
+
+        if (cmd.clip != scissor)
+        {
+            m_gl->Scissor(cmd.clip.left, height - (cmd.clip.top + cmd.clip.height), cmd.clip.width, cmd.clip.height);
+            scissor = cmd.clip;
+            ++stats.clipChanges;
+        }
+
+        const sf::Texture* texture = cmd.states.texture;
+        GLuint handle = texture ? texture->getNativeHandle() : 0;
+        if (handle != boundTexture)
+        {
+            m_gl->BindTexture(GL_TEXTURE_2D, handle);
+            boundTexture = handle;
+            ++stats.textureSwitches;
+
+            if (m_textured != (texture != nullptr))
+            {
+                m_textured = texture != nullptr;
+                m_gl->Uniform1i(m_uTextured, m_textured);
+            }
+            if (texture && texture->getSize() != m_texSize)
+            {
+                m_texSize = texture->getSize();
+                m_gl->Uniform2f(m_uTexScale, 1.f / (float)m_texSize.x, 1.f / (float)m_texSize.y);
+            }
+        }
+
+        m_gl->DrawArrays(primitive(cmd.type), base + (GLint)(cmd.first - firstVertex), (GLsizei)cmd.count);
+        stats.count(cmd);
+    }
+
+    if (m_persistent)
+        m_fences[m_region] = m_gl->FenceSync(gl::SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    // Leave the rest to SFML
+    m_gl->Disable(GL_SCISSOR_TEST);
+    m_gl->BindVertexArray(0);
+    m_gl->BindBuffer(gl::ARRAY_BUFFER, 0);
+    m_gl->UseProgram(0);
+    target.resetGLStates();
+
+    return end;
+}
+
+} // namespace gfx
+} // namespace sfw
+
+#endif // SFW_CFG_GFX_USE_OPENGL
@@ -0,0 +1,770 @@
+#include "sfw/Gfx/Render.hpp"
+#include "sfw/Gfx/SdfFont.hpp"
+#include "sfw/Gfx/TextLayout.hpp"
+#include "sfw/Theme.hpp"
+#include "sfw/util/alloc_guard.hpp"
+#ifdef SFW_CFG_GFX_USE_OPENGL
+#include "sfw/Gfx/Render_gl.hpp"
+#endif
+
+#include <SFML/Graphics/Texture.hpp>
+#include <SFML/Graphics/Font.hpp>
+#include <SFML/Graphics/Glyph.hpp>
+
+#include <algorithm>
+    using std::min, std::max;
+#include <cmath>
+#include <cstdint>
+#include <climits>
+#include <cfloat>
+#include <cassert>
+
+namespace sfw
+{
+namespace gfx
+{
+
+//----------------------------------------------------------------------------
+// Glyph geometry, the same way sf::Text would generate it
+//
+namespace
+{
+    // Make room for `extra` more items
+    // Pool growth is a warm-up (or new content) thing, not a per-frame cost,
+    // so it's exempt from the allocation guard (see GUI::render()).
+    template <class T>
+    void reserveFor(std::vector<T>& v, size_t extra)
+    {
+        if (v.size() + extra > v.capacity())
+        {
+            AllocationGuard::Pause exempt;
+            v.reserve(max(v.capacity() * 2, v.size() + extra));
+        }
+    }
+
+    // `bounds` (relative to `pos`) is mapped to `texRect`
+    void addGlyphQuad(std::vector<sf::Vertex>& out, sf::Vector2f pos, sf::Color color,
+                      const sf::FloatRect& bounds, const sf::FloatRect& texRect, float italicShear)
+    {
+        float left   = bounds.left;
+        float top    = bounds.top;
+        float right  = bounds.left + bounds.width;
+        float bottom = bounds.top  + bounds.height;
+
+        float u1 = texRect.left;
+        float v1 = texRect.top;
+        float u2 = texRect.left + texRect.width;
+        float v2 = texRect.top  + texRect.height;
+
+        out.emplace_back(sf::Vector2f(pos.x + left  - italicShear * top,    pos.y + top),    color, sf::Vector2f(u1, v1));
+        out.emplace_back(sf::Vector2f(pos.x + right - italicShear * top,    pos.y + top),    color, sf::Vector2f(u2, v1));
+        out.emplace_back(sf::Vector2f(pos.x + left  - italicShear * bottom, pos.y + bottom), color, sf::Vector2f(u1, v2));
+        out.emplace_back(sf::Vector2f(pos.x + left  - italicShear * bottom, pos.y + bottom), color, sf::Vector2f(u1, v2));
+        out.emplace_back(sf::Vector2f(pos.x + right - italicShear * top,    pos.y + top),    color, sf::Vector2f(u2, v1));
+        out.emplace_back(sf::Vector2f(pos.x + right - italicShear * bottom, pos.y + bottom), color, sf::Vector2f(u2, v2));
+    }
+
+    // `texel`: a solid one in the texture (SFML keeps a white pixel at (1, 1)
+    // on every font page for this)
+    void addLine(std::vector<sf::Vertex>& out, float lineLength, float lineTop, sf::Color color,
+                 float offset, float thickness, sf::Vector2f texel)
+    {
+        float top = std::floor(lineTop + offset - (thickness / 2) + 0.5f);
+        float bottom = top + std::floor(thickness + 0.5f);
+
+        out.emplace_back(sf::Vector2f(0,          top),    color, texel);
+        out.emplace_back(sf::Vector2f(lineLength, top),    color, texel);
+        out.emplace_back(sf::Vector2f(0,          bottom), color, texel);
+        out.emplace_back(sf::Vector2f(0,          bottom), color, texel);
+        out.emplace_back(sf::Vector2f(lineLength, top),    color, texel);
+        out.emplace_back(sf::Vector2f(lineLength, bottom), color, texel);
+    }
+} // namespace
+
+
+//============================================================================
+void DrawList::add(const sf::Vertex* vertices, size_t count, sf::PrimitiveType type,
+                   const sf::RenderStates& states, const sf::IntRect& clip)
+{
+    reserveFor(m_commands, 1);
+    reserveFor(m_vertices, count);
+    m_commands.push_back({type, m_vertices.size(), count, states, clip});
+    m_vertices.insert(m_vertices.end(), vertices, vertices + count);
+}
+
+
+bool DrawList::sameAs(const DrawList& other) const
+{
+    if (m_commands.size() != other.m_commands.size() || m_vertices.size() != other.m_vertices.size()
+        || view.getTransform() != other.view.getTransform() || view.getViewport() != other.view.getViewport())
+        return false;
+
+    for (size_t i = 0; i < m_commands.size(); ++i)
+    {
+        const Command& a = m_commands[i];
+        const Command& b = other.m_commands[i];
+        if (a.type != b.type || a.first != b.first || a.count != b.count || a.clip != b.clip
+            || a.states.shader || b.states.shader
+            || a.states.texture != b.states.texture || a.states.blendMode != b.states.blendMode
+            || a.states.transform != b.states.transform)
+            return false;
+    }
+
+    for (size_t i = 0; i < m_vertices.size(); ++i)
+    {
+        const sf::Vertex& a = m_vertices[i];
+        const sf::Vertex& b = other.m_vertices[i];
+        if (a.position != b.position || a.color != b.color || a.texCoords != b.texCoords)
+            return false;
+    }
+    return true;
+}
+
+
+//============================================================================
+Renderer::Renderer(sf::RenderTarget& target):
+    m_target(target)
+{
+}
+
+Renderer::~Renderer() = default;
+
+
+void Renderer::render(const Drawable& object, const sf::RenderStates& states)
+{
+    begin();
+    object.draw(RenderContext{m_target, states, *this});
+    end();
+}
+
+
+void Renderer::begin()
+{
+    m_stats = {};
+    m_lastTexture = nullptr;
+    m_batchCount = 0;
+    m_baseView = m_target.getView();
+    m_baseClip = m_target.getViewport(m_baseView);
+    m_clipStack.clear();
+    resetGrid();
+
+    // Keep the last frame for comparison (swapping keeps both pools intact)
+    std::swap(m_drawList, m_prevDrawList);
+    m_drawList.clear();
+    m_drawList.view = m_baseView;
+    m_submitted = 0;
+}
+
+
+void Renderer::end()
+{
+    closeBatches();
+    if (m_skipUnchanged && m_submitted == 0 && m_drawList.sameAs(m_prevDrawList))
+    {
+        m_stats.skipped = true;
+        return;
+    }
+    flush();
+}
+
+
+void Renderer::resetGrid()
+{
+    // (Re)size the occupancy grid to the current view:
+    const sf::View& view = m_target.getView();
+    m_gridArea = {view.getCenter() - view.getSize() / 2.f, view.getSize()};
+    m_gridWidth  = (size_t)max(1.f, std::ceil(std::abs(m_gridArea.width)  / GRID_CELL_SIZE));
+    m_gridHeight = (size_t)max(1.f, std::ceil(std::abs(m_gridArea.height) / GRID_CELL_SIZE));
+    if (m_gridWidth * m_gridHeight > m_grid.capacity())
+    {
+        AllocationGuard::Pause exempt; // The view has grown
+        m_grid.reserve(m_gridWidth * m_gridHeight);
+    }
+    m_grid.assign(m_gridWidth * m_gridHeight, 0);
+}
+
+
+// Clipping ------------------------------------------------------------------
+
+void Renderer::pushClip(const sf::FloatRect& rect, const sf::Transform& transform)
+{
+    // Map to target pixels (via the original view, whatever has been applied since):
+    sf::Vector2i lo{INT_MAX, INT_MAX}, hi{INT_MIN, INT_MIN};
+    for (sf::Vector2f corner : {rect.getPosition(),
+                                rect.getPosition() + sf::Vector2f(rect.width, 0),
+                                rect.getPosition() + sf::Vector2f(0, rect.height),
+                                rect.getPosition() + rect.getSize()})
+    {
+        sf::Vector2i p = m_target.mapCoordsToPixel(transform.transformPoint(corner), m_baseView);
+        lo.x = min(lo.x, p.x); hi.x = max(hi.x, p.x);
+        lo.y = min(lo.y, p.y); hi.y = max(hi.y, p.y);
+    }
+
+    // Intersect with the current one (an empty result is fine: draws will be dropped)
+    const sf::IntRect& outer = clip();
+    lo.x = max(lo.x, outer.left); hi.x = min(hi.x, outer.left + outer.width);
+    lo.y = max(lo.y, outer.top);  hi.y = min(hi.y, outer.top  + outer.height);
+
+    reserveFor(m_clipStack, 1);
+    m_clipStack.emplace_back(lo, sf::Vector2i(max(0, hi.x - lo.x), max(0, hi.y - lo.y)));
+}
+
+
+void Renderer::popClip()
+{
+    assert(!m_clipStack.empty());
+    if (!m_clipStack.empty())
+        m_clipStack.pop_back();
+}
+
+
+sf::FloatRect Renderer::clipArea(const sf::Transform& transform) const
+{
+    const sf::IntRect& pixels = clip();
+    if (pixels.width <= 0 || pixels.height <= 0)
+        return {};
+
+    sf::Transform toLocal = transform.getInverse();
+    sf::Vector2f lo{FLT_MAX, FLT_MAX}, hi{-FLT_MAX, -FLT_MAX};
+    for (sf::Vector2i corner : {pixels.getPosition(),
+                                pixels.getPosition() + sf::Vector2i(pixels.width, 0),
+                                pixels.getPosition() + sf::Vector2i(0, pixels.height),
+                                pixels.getPosition() + pixels.getSize()})
+    {
+        sf::Vector2f p = toLocal.transformPoint(m_target.mapPixelToCoords(corner, m_baseView));
+        lo.x = min(lo.x, p.x); hi.x = max(hi.x, p.x);
+        lo.y = min(lo.y, p.y); hi.y = max(hi.y, p.y);
+    }
+    return {lo, hi - lo};
+}
+
+
+sf::View Renderer::clipView(const sf::View& view, const sf::IntRect& pixels, sf::Vector2u size)
+{
+    const sf::FloatRect& vp = view.getViewport();
+    sf::Vector2f vpSize = {vp.width * (float)size.x, vp.height * (float)size.y};
+
+    // Pixel -> normalized device coords. (of the original view) -> world
+    sf::Vector2f center = {(float)pixels.left + (float)pixels.width / 2, (float)pixels.top + (float)pixels.height / 2};
+    sf::Vector2f ndc = {       (center.x - vp.left * (float)size.x) / vpSize.x * 2 - 1,
+                        1.f - (center.y - vp.top  * (float)size.y) / vpSize.y * 2};
+
+    sf::View clip = view; // Keep the rotation, if any
+    clip.setCenter(view.getInverseTransform().transformPoint(ndc));
+    clip.setSize({view.getSize().x * (float)pixels.width  / vpSize.x,
+                  view.getSize().y * (float)pixels.height / vpSize.y});
+    clip.setViewport({{(float)pixels.left  / (float)size.x, (float)pixels.top    / (float)size.y},
+                      {(float)pixels.width / (float)size.x, (float)pixels.height / (float)size.y}});
+    return clip;
+}
+
+
+// Drawing -------------------------------------------------------------------
+
+void Renderer::draw(const sf::Vertex* vertices, size_t vertexCount, sf::PrimitiveType type,
+                    const sf::RenderStates& states)
+{
+    if (!vertices || !vertexCount)
+        return; // Nothing to draw (just like SFML)
+
+    if (vertexCount < 3
+        || (type != sf::PrimitiveType::Triangles
+         && type != sf::PrimitiveType::TriangleStrip
+         && type != sf::PrimitiveType::TriangleFan)
+        || states.shader || states.blendMode != sf::BlendAlpha)
+    {
+        // Not for us, just keep the order:
+        closeBatches();
+        ensureFrame();
+        if (!clippedOut())
+            m_drawList.add(vertices, vertexCount, type, states, clip());
+        return;
+    }
+
+    // Untextured geometry would use the solid texel of the theme texture:
+    bool solid = !states.texture;
+
+    m_chunk.clear();
+    reserveFor(m_chunk, vertexCount * 3);
+    switch (type)
+    {
+    case sf::PrimitiveType::Triangles:
+        for (size_t i = 2; i < vertexCount; i += 3)
+            appendTriangle(vertices[i - 2], vertices[i - 1], vertices[i], states.transform, solid);
+        break;
+    case sf::PrimitiveType::TriangleStrip:
+        for (size_t i = 2; i < vertexCount; ++i)
+            appendTriangle(vertices[i - 2], vertices[i - 1], vertices[i], states.transform, solid);
+        break;
+    case sf::PrimitiveType::TriangleFan:
+        for (size_t i = 2; i < vertexCount; ++i)
+            appendTriangle(vertices[0], vertices[i - 1], vertices[i], states.transform, solid);
+        break;
+    default:; // Can't get here.
+    }
+    commitChunk(solid ? &Theme::getTexture() : states.texture);
+}
+
+
+void Renderer::draw(const sf::Text& text, const sf::RenderStates& states)
+{
+    const sf::Font* font = text.getFont();
+    if (!font || text.getOutlineThickness() != 0
+        || states.shader || states.blendMode != sf::BlendAlpha)
+    {
+        draw((const sf::Drawable&)text, states);
+        return;
+    }
+
+    const sf::String& str = text.getString();
+    if (str.isEmpty())
+        return;
+
+    auto fontLock = lockFonts();
+
+    // Make room for the worst case (a quad per char, or two lines per
+    // newline), so the quads below never need to grow the vertex storage
+    m_chunk.clear();
+    reserveFor(m_chunk, (str.getSize() + 1) * 12);
+
+    unsigned size = text.getCharacterSize();
+    std::uint32_t style = text.getStyle();
+    sf::Color color = text.getFillColor();
+
+    bool  isBold          = style & sf::Text::Bold;
+    bool  isUnderlined    = style & sf::Text::Underlined;
+    bool  isStrikeThrough = style & sf::Text::StrikeThrough;
+    float italicShear     = (style & sf::Text::Italic) ? 0.209f : 0.f; // 12 degrees, like SFML
+
+    // Resolution-independent glyphs, if enabled (and available), so no new
+    // glyphs need to be rasterized for a new size (see SdfFont); laid out
+    // exactly as the widgets measure it (see TextLayout)
+    SdfFont* sdf = m_textMode == TextMode::Auto ? TextLayout::fontOf(text)
+                 : m_textMode == TextMode::Sdf  ? SdfFont::of(*font)
+                 : nullptr;
+    if (sdf)
+    {
+        sf::Vector2f solidTexel = sdf->getSolidTexel();
+        TextLayout layout(text, *sdf);
+        while (layout.next())
+        {
+            sf::Vector2f pen = layout.pen();
+            if (layout.endsLine())
+            {
+                if (isUnderlined)    addLine(m_chunk, pen.x, pen.y, color, layout.underlineOffset(), layout.underlineThickness(), solidTexel);
+                if (isStrikeThrough) addLine(m_chunk, pen.x, pen.y, color, layout.strikeThroughOffset(), layout.underlineThickness(), solidTexel);
+            }
+            if (const SdfFont::Glyph* glyph = layout.glyph(); glyph && glyph->textureRect.width > 0)
+                addGlyphQuad(m_chunk, pen, color, layout.quadBounds(), glyph->textureRect, italicShear);
+        }
+        if (sf::Vector2f pen = layout.pen(); pen.x > 0)
+        {
+            if (isUnderlined)    addLine(m_chunk, pen.x, pen.y, color, layout.underlineOffset(), layout.underlineThickness(), solidTexel);
+            if (isStrikeThrough) addLine(m_chunk, pen.x, pen.y, color, layout.strikeThroughOffset(), layout.underlineThickness(), solidTexel);
+        }
+
+        sf::Transform transform = states.transform * text.getTransform();
+        for (auto& v : m_chunk)
+            v.position = transform.transformPoint(v.position);
+        commitChunk(&sdf->getTexture(), SdfFont::shader());
+        return;
+    }
+
+    // SFML loads (rasterizes) the glyphs on demand, also for the kerning:
+    // that allocates for a new glyph (which is legit "new content", not a
+    // per-frame cost, see GUI::render()), but the cache lookup is internal
+    // to sf::Font, so the exemption can only be scoped to the font calls.
+    auto glyphOf = [font](std::uint32_t c, unsigned charSize, bool bold) -> const sf::Glyph& {
+        AllocationGuard::Pause exempt;
+        return font->getGlyph(c, charSize, bold);
+    };
+    auto kerning = [font](std::uint32_t a, std::uint32_t b, unsigned charSize, bool bold) {
+        AllocationGuard::Pause exempt;
+        return font->getKerning(a, b, charSize, bold);
+    };
+
+    sf::Vector2f pageTexel(1, 1); // (See addLine().)
+    float underlineOffset    = font->getUnderlinePosition(size);
+    float underlineThickness = font->getUnderlineThickness(size);
+
+    sf::FloatRect xBounds = glyphOf(U'x', size, isBold).bounds;
+    float strikeThroughOffset = xBounds.top + xBounds.height / 2.f;
+    float whitespaceWidth = glyphOf(U' ', size, isBold).advance;
+    float letterSpacing   = (whitespaceWidth / 3.f) * (text.getLetterSpacing() - 1.f);
+    whitespaceWidth      += letterSpacing;
+    float lineSpacing     = font->getLineSpacing(size) * text.getLineSpacing();
+
+    // Generate the glyph quads (in the local coord. space of the text):
+    float x = 0.f;
+    float y = (float)size;
+    std::uint32_t prevChar = 0;
+    for (size_t i = 0; i < str.getSize(); ++i)
+    {
+        std::uint32_t curChar = str[i];
+        if (curChar == U'\r')
+            continue;
+
+        x += kerning(prevChar, curChar, size, isBold);
+
+        if (curChar == U'\n' && prevChar != U'\n')
+        {
+            if (isUnderlined)    addLine(m_chunk, x, y, color, underlineOffset, underlineThickness, pageTexel);
+            if (isStrikeThrough) addLine(m_chunk, x, y, color, strikeThroughOffset, underlineThickness, pageTexel);
+        }
+        prevChar = curChar;
+
+        switch (curChar)
+        {
+        case U' ':  x += whitespaceWidth;     continue;
+        case U'\t': x += whitespaceWidth * 4; continue;
+        case U'\n': y += lineSpacing; x = 0;  continue;
+        }
+
+        // With a 1px margin of the (padded) glyph page around the glyphs, for filtering
+        const sf::Glyph& glyph = glyphOf(curChar, size, isBold);
+        const float padding = 1.0;
+        addGlyphQuad(m_chunk, {x, y}, color,
+                     {{glyph.bounds.left - padding, glyph.bounds.top - padding},
+                      {glyph.bounds.width + 2 * padding, glyph.bounds.height + 2 * padding}},
+                     {{(float)glyph.textureRect.left - padding, (float)glyph.textureRect.top - padding},
+                      {(float)glyph.textureRect.width + 2 * padding, (float)glyph.textureRect.height + 2 * padding}},
+                     italicShear);
+        x += glyph.advance + letterSpacing;
+    }
+    if (x > 0)
+    {
+        if (isUnderlined)    addLine(m_chunk, x, y, color, underlineOffset, underlineThickness, pageTexel);
+        if (isStrikeThrough) addLine(m_chunk, x, y, color, strikeThroughOffset, underlineThickness, pageTexel);
+    }
+
+    // Transform to target space:
+    sf::Transform transform = states.transform * text.getTransform();
+    for (auto& v : m_chunk)
+        v.position = transform.transformPoint(v.position);
+
+    // The font page must be fetched only now, after all the glyphs have been loaded:
+    commitChunk(&font->getTexture(size));
+}
+
+
+void Renderer::draw(const sf::Sprite& sprite, const sf::RenderStates& states)
+{
+    const sf::Texture* texture = sprite.getTexture();
+    if (!texture || states.shader || states.blendMode != sf::BlendAlpha)
+    {
+        draw((const sf::Drawable&)sprite, states);
+        return;
+    }
+
+    sf::FloatRect r(sprite.getTextureRect());
+    sf::Color color = sprite.getColor();
+    sf::Vertex quad[4] = {
+        {{0,                 0},                  color, {r.left,           r.top}},
+        {{0,                 std::abs(r.height)}, color, {r.left,           r.top + r.height}},
+        {{std::abs(r.width), 0},                  color, {r.left + r.width, r.top}},
+        {{std::abs(r.width), std::abs(r.height)}, color, {r.left + r.width, r.top + r.height}},
+    };
+    auto lstates = states;
+    lstates.transform *= sprite.getTransform();
+    lstates.texture = texture;
+    draw(quad, 4, sf::PrimitiveType::TriangleStrip, lstates);
+}
+
+
+void Renderer::draw(const sf::Drawable& object, const sf::RenderStates& states)
+{
+    flush();
+    ensureFrame();
+    if (clippedOut() || m_recordOnly)
+        return;
+
+    if (clip() != m_baseClip)
+    {
+        m_target.setView(clipView(m_baseView, clip(), m_target.getSize()));
+        ++m_stats.clipChanges;
+    }
+    submit(object, states);
+    if (clip() != m_baseClip)
+        m_target.setView(m_baseView);
+}
+
+
+void Renderer::fillRect(const sf::FloatRect& rect, sf::Color color, const sf::RenderStates& states)
+{
+    sf::Vertex quad[4] = {
+        {{rect.left,              rect.top},               color},
+        {{rect.left,              rect.top + rect.height}, color},
+        {{rect.left + rect.width, rect.top},               color},
+        {{rect.left + rect.width, rect.top + rect.height}, color},
+    };
+    auto lstates = states;
+    lstates.texture = nullptr;
+    draw(quad, 4, sf::PrimitiveType::TriangleStrip, lstates);
+}
+
+
+void Renderer::drawNineSlice(const sf::FloatRect& rect, float border, sf::Vector2f texPos,
+                             const sf::Texture& texture, const sf::RenderStates& states)
+{
+    if (states.shader || states.blendMode != sf::BlendAlpha)
+    {
+        sf::Vertex vertices[NINE_SLICE_VERTICES];
+        auto lstates = states;
+        lstates.texture = &texture;
+        draw(vertices, nineSlice(vertices, rect, border, texPos), sf::PrimitiveType::Triangles, lstates);
+        return;
+    }
+
+    m_chunk.clear();
+    reserveFor(m_chunk, NINE_SLICE_VERTICES);
+    m_chunk.resize(NINE_SLICE_VERTICES);
+    m_chunk.resize(nineSlice(m_chunk.data(), rect, border, texPos, states.transform));
+    commitChunk(&texture);
+}
+
+
+size_t Renderer::nineSlice(sf::Vertex* out, const sf::FloatRect& rect, float border, sf::Vector2f texPos,
+                           const sf::Transform& transform)
+{
+    if (rect.width <= 0 || rect.height <= 0)
+        return 0;
+
+    // 0--x1--x2--x3
+    // |   |   |   |
+    // y1--+---+---+
+    // |   |   |   |
+    // y2--+---+---+
+    // |   |   |   |
+    // y3--+---+---+
+    const float xs[4] = {rect.left, rect.left + border, rect.left + rect.width - border, rect.left + rect.width};
+    const float ys[4] = {rect.top,  rect.top + border,  rect.top + rect.height - border, rect.top + rect.height};
+
+    size_t n = 0;
+    for (int row = 0; row < 3; ++row)
+    {
+        if (ys[row + 1] <= ys[row])
+            continue;
+        float v1 = texPos.y + border * (float)row, v2 = v1 + border;
+        for (int col = 0; col < 3; ++col)
+        {
+            if (xs[col + 1] <= xs[col])
+                continue;
+            float u1 = texPos.x + border * (float)col, u2 = u1 + border;
+            sf::Vector2f tl = transform.transformPoint({xs[col],     ys[row]}),
+                         tr = transform.transformPoint({xs[col + 1], ys[row]}),
+                         bl = transform.transformPoint({xs[col],     ys[row + 1]}),
+                         br = transform.transformPoint({xs[col + 1], ys[row + 1]});
+            out[n++] = {tl, sf::Color::White, {u1, v1}};
+            out[n++] = {bl, sf::Color::White, {u1, v2}};
+            out[n++] = {tr, sf::Color::White, {u2, v1}};
+            out[n++] = {tr, sf::Color::White, {u2, v1}};
+            out[n++] = {bl, sf::Color::White, {u1, v2}};
+            out[n++] = {br, sf::Color::White, {u2, v2}};
+        }
+    }
+    return n;
+}
+
+
+void Renderer::flush()
+{
+    closeBatches();
+    if (m_recordOnly)
+        return;
+    submit(m_drawList, m_submitted);
+    m_submitted = m_drawList.commands().size();
+}
+
+
+void Renderer::append(const DrawList& list)
+{
+    closeBatches(); // Keep the order
+    ensureFrame();
+    for (const auto& cmd : list.commands())
+        m_drawList.add(list.vertices().data() + cmd.first, cmd.count, cmd.type, cmd.states, cmd.clip);
+}
+
+
+void Renderer::closeBatches()
+{
+    for (size_t i = 0; i < m_batchCount; ++i)
+    {
+        auto& batch = m_batches[i];
+        sf::RenderStates states(batch.texture);
+        states.shader = batch.shader;
+        m_drawList.add(batch.vertices.data(), batch.vertices.size(), sf::PrimitiveType::Triangles,
+                       states, batch.clip);
+        m_stats.batchedVertices += batch.vertices.size();
+        batch.vertices.clear(); // Keeps the capacity, so no reallocs in the steady state
+    }
+    m_batchCount = 0;
+    std::fill(m_grid.begin(), m_grid.end(), 0);
+}
+
+
+// Submission ----------------------------------------------------------------
+
+void Renderer::submit(const DrawList& list, size_t from)
+{
+    if (from >= list.commands().size())
+        return;
+
+#ifdef SFW_CFG_GFX_USE_OPENGL
+    if (!m_gl && m_target.setActive(true))
+    {
+        AllocationGuard::Pause exempt; // Once per renderer (and created once per process)
+        m_gl = GLBackend::shared();
+    }
+#endif
+
+    // Set up the view of the list, then switch to the clip views as needed:
+    m_target.setView(list.view);
+    const sf::IntRect base = m_target.getViewport(list.view);
+    sf::IntRect applied = base;
+    for (size_t i = from; i < list.commands().size(); ++i)
+    {
+#ifdef SFW_CFG_GFX_USE_OPENGL
+        // Draw as much as possible natively (it doesn't touch the SFML view)
+        if (m_gl && m_gl->ready())
+        {
+            i = m_gl->submit(m_target, list, i, m_stats);
+            m_lastTexture = nullptr;
+            if (i == list.commands().size())
+                break;
+        }
+#endif
+        const auto& cmd = list.commands()[i];
+        if (cmd.clip != applied)
+        {
+            m_target.setView(cmd.clip == base ? list.view : clipView(list.view, cmd.clip, m_target.getSize()));
+            applied = cmd.clip;
+            ++m_stats.clipChanges;
+        }
+        submit(list, cmd);
+    }
+    if (applied != base)
+        m_target.setView(list.view);
+}
+
+
+void Renderer::Stats::count(const DrawList::Command& cmd)
+{
+    ++drawCalls;
+    vertices += cmd.count;
+    switch (cmd.type)
+    {
+    case sf::PrimitiveType::Points:        primitives += cmd.count; break;
+    case sf::PrimitiveType::Lines:         primitives += cmd.count / 2; break;
+    case sf::PrimitiveType::LineStrip:     primitives += cmd.count ? cmd.count - 1 : 0; break;
+    case sf::PrimitiveType::Triangles:     primitives += cmd.count / 3; break;
+    case sf::PrimitiveType::TriangleStrip:
+    case sf::PrimitiveType::TriangleFan:   primitives += cmd.count > 2 ? cmd.count - 2 : 0; break;
+    default:;
+    }
+}
+
+
+void Renderer::submit([[maybe_unused]] const DrawList& list, const DrawList::Command& cmd)
+{
+    m_stats.count(cmd);
+    if (cmd.states.texture != m_lastTexture)
+    {
+        ++m_stats.textureSwitches;
+        m_lastTexture = cmd.states.texture;
+    }
+
+#ifndef SFW_CFG_GFX_USE_NULL
+    m_target.draw(list.vertices().data() + cmd.first, cmd.count, cmd.type, cmd.states);
+#endif
+}
+
+
+void Renderer::submit([[maybe_unused]] const sf::Drawable& object, [[maybe_unused]] const sf::RenderStates& states)
+{
+    // Its geometry (and texture) is opaque to us, so this is just a draw call:
+    ++m_stats.drawCalls;
+    m_lastTexture = nullptr; // Whatever it was, it's been switched, probably
+
+#ifndef SFW_CFG_GFX_USE_NULL
+    m_target.draw(object, states);
+#endif
+}
+
+
+// Batching ------------------------------------------------------------------
+
+void Renderer::appendTriangle(const sf::Vertex& v0, const sf::Vertex& v1, const sf::Vertex& v2,
+                              const sf::Transform& transform, bool solid)
+{
+    // Skip the degenerate ones (e.g. the "carriage returns" of the Box strips):
+    if (v0.position == v1.position || v1.position == v2.position || v0.position == v2.position)
+        return;
+
+    for (const sf::Vertex* v : {&v0, &v1, &v2})
+    {
+        m_chunk.emplace_back(transform.transformPoint(v->position), v->color,
+                             solid ? Theme::getSolidTexel() : v->texCoords);
+    }
+}
+
+
+void Renderer::commitChunk(const sf::Texture* texture, const sf::Shader* shader)
+{
+    ensureFrame();
+    if (m_chunk.empty() || clippedOut())
+        return;
+
+    // Find the grid cells covered by the chunk:
+    sf::Vector2f lo = m_chunk[0].position, hi = lo;
+    for (const auto& v : m_chunk)
+    {
+        lo.x = min(lo.x, v.position.x); hi.x = max(hi.x, v.position.x);
+        lo.y = min(lo.y, v.position.y); hi.y = max(hi.y, v.position.y);
+    }
+    auto cell = [this](float pos, float origin, float extent, size_t count) {
+        float c = (pos - origin) / extent * (float)count;
+        return (size_t)std::clamp(c, 0.f, (float)count - 1);
+    };
+    size_t x0 = cell(lo.x, m_gridArea.left, m_gridArea.width,  m_gridWidth),
+           x1 = cell(hi.x, m_gridArea.left, m_gridArea.width,  m_gridWidth),
+           y0 = cell(lo.y, m_gridArea.top,  m_gridArea.height, m_gridHeight),
+           y1 = cell(hi.y, m_gridArea.top,  m_gridArea.height, m_gridHeight);
+    if (x0 > x1) std::swap(x0, x1); // Flipped views...
+    if (y0 > y1) std::swap(y0, y1);
+
+    // The chunk can't go before anything already drawn below it:
+    size_t lowest = 0;
+    for (size_t y = y0; y <= y1; ++y)
+        for (size_t x = x0; x <= x1; ++x)
+            lowest = max(lowest, m_grid[y * m_gridWidth + x]);
+
+    // Join the last batch of the same texture, shader & clip, if it's not below that floor:
+    const sf::IntRect& clip = this->clip();
+    size_t target = m_batchCount; // 1-based
+    while (target > 0 && (m_batches[target - 1].texture != texture || m_batches[target - 1].shader != shader
+                          || m_batches[target - 1].clip != clip))
+        --target;
+    if (target == 0 || target < lowest)
+    {
+        if (m_batchCount == m_batches.size())
+        {
+            AllocationGuard::Pause exempt; // Pool growth
+            m_batches.emplace_back();
+        }
+        target = ++m_batchCount;
+        m_batches[target - 1].texture = texture;
+        m_batches[target - 1].shader = shader;
+        m_batches[target - 1].clip = clip;
+    }
+
+    auto& vertices = m_batches[target - 1].vertices;
+    reserveFor(vertices, m_chunk.size());
+    vertices.insert(vertices.end(), m_chunk.begin(), m_chunk.end());
+
+    for (size_t y = y0; y <= y1; ++y)
+        for (size_t x = x0; x <= x1; ++x)
+            m_grid[y * m_gridWidth + x] = max(m_grid[y * m_gridWidth + x], target);
+}
+
+} // namespace gfx
+} // namespace sfw
@@ -0,0 +1,396 @@
+#include "sfw/Gfx/SdfFont.hpp"
+#include "sfw/Gfx/Render.hpp"
+#include "sfw/Theme.hpp"
+#include "sfw/util/alloc_guard.hpp"
+
+#ifdef SFW_SDF_TEXT
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include FT_OUTLINE_H
+#endif
+
+#include <algorithm>
+    using std::min, std::max;
+#include <cmath>
+#include <memory>
+#include <iostream>
+    using std::cerr;
+
+namespace sfw
+{
+namespace gfx
+{
+
+namespace
+{
+    constexpr unsigned ATLAS_WIDTH = 1024;
+    constexpr unsigned ATLAS_INITIAL_HEIGHT = 256;
+    constexpr unsigned ATLAS_MAX_HEIGHT = 4096; // (Every GL 3 implementation can do that much.)
+    constexpr unsigned GAP = 1; // Between the glyphs in the atlas
+    constexpr float FAR = 1e20f;
+
+    // The edge is where the distance crosses 0.5; the smoothing is about
+    // one screen pixel wide, whatever the scale (that's what fwidth() tells)
+    const char* FRAGMENT_SHADER = R"(#version 110
+uniform sampler2D texture;
+void main()
+{
+    float distance = texture2D(texture, gl_TexCoord[0].xy).a;
+    float width = max(fwidth(distance) * 0.7, 0.0001);
+    float coverage = smoothstep(0.5 - width, 0.5 + width, distance);
+    gl_FragColor = vec4(gl_Color.rgb, gl_Color.a * coverage);
+}
+)";
+
+#ifdef SFW_SDF_TEXT
+    // Squared distance transform of a row or column (Felzenszwalb & Huttenlocher)
+    // f: 0 at the "seeds", FAR elsewhere; v, z: scratch space (n and n + 1)
+    void distance1D(const float* f, float* d, int n, int* v, float* z)
+    {
+        auto intersection = [&](int q, int p) {
+            return ((f[q] + (float)(q * q)) - (f[p] + (float)(p * p))) / (float)(2 * q - 2 * p);
+        };
+        int k = 0;
+        v[0] = 0; z[0] = -FAR; z[1] = FAR;
+        for (int q = 1; q < n; ++q)
+        {
+            float s = intersection(q, v[k]);
+            while (s <= z[k]) // (Can't go below z[0], as |s| < FAR / 2.)
+                s = intersection(q, v[--k]);
+            ++k;
+            v[k] = q; z[k] = s; z[k + 1] = FAR;
+        }
+        k = 0;
+        for (int q = 0; q < n; ++q)
+        {
+            while (z[k + 1] < (float)q) ++k;
+            float dq = (float)(q - v[k]);
+            d[q] = dq * dq + f[v[k]];
+        }
+    }
+
+    // Squared distances to the nearest seed, in place (w x h)
+    void distance2D(std::vector<float>& grid, int w, int h)
+    {
+        int n = max(w, h);
+        std::vector<float> f(n), d(n), z(n + 1);
+        std::vector<int> v(n);
+        for (int x = 0; x < w; ++x)
+        {
+            for (int y = 0; y < h; ++y) f[y] = grid[y * w + x];
+            distance1D(f.data(), d.data(), h, v.data(), z.data());
+            for (int y = 0; y < h; ++y) grid[y * w + x] = d[y];
+        }
+        for (int y = 0; y < h; ++y)
+        {
+            distance1D(&grid[y * w], d.data(), w, v.data(), z.data());
+            std::copy(d.begin(), d.begin() + w, grid.begin() + y * w);
+        }
+    }
+#endif // SFW_SDF_TEXT
+
+    auto& registry()
+    {
+        static std::unordered_map<const sf::Font*, std::unique_ptr<SdfFont>> fonts;
+        return fonts;
+    }
+} // namespace
+
+
+//============================================================================
+SdfFont* SdfFont::load(const sf::Font& font, const std::string& filename)
+{
+    if constexpr (!available)
+        return nullptr; // (Plain text then; see forText().)
+
+    std::unique_ptr<SdfFont> atlas(new SdfFont());
+    if (!atlas->open(filename))
+    {
+        cerr << "- Warning: No SDF text with \"" << filename << "\" (not a scalable font?), drawing plain text instead.\n";
+        registry().erase(&font);
+        return nullptr;
+    }
+    return (registry()[&font] = std::move(atlas)).get();
+}
+
+
+SdfFont* SdfFont::of(const sf::Font& font)
+{
+    auto it = registry().find(&font);
+    return it != registry().end() ? it->second.get() : nullptr;
+}
+
+
+SdfFont* SdfFont::forText(const sf::Font& font)
+{
+    if (!Theme::sdfText)
+        return nullptr;
+    if constexpr (!available)
+    {
+        static bool warned = [] {
+            cerr << "- Warning: SDF text is not built in (see SFW_SDF_TEXT), drawing plain text instead.\n";
+            return true;
+        }();
+        (void)warned;
+        return nullptr;
+    }
+    // (Nothing is drawn with the headless backend, so the shader doesn't matter there.)
+    if (!Renderer::headless && !shader())
+        return nullptr;
+    return of(font);
+}
+
+
+SdfFont* SdfFont::ofTexture(const sf::Texture* texture)
+{
+    for (auto& [font, atlas] : registry()) // (There are just a few fonts.)
+        if (&atlas->m_texture == texture)
+            return atlas.get();
+    return nullptr;
+}
+
+
+void SdfFont::forget(const sf::Font& font)
+{
+    registry().erase(&font);
+}
+
+
+const sf::Shader* SdfFont::shader()
+{
+    if constexpr (Renderer::headless)
+        return nullptr;
+
+    static sf::Shader shader;
+    static bool ready = [] {
+        if (!sf::Shader::isAvailable() || !shader.loadFromMemory(FRAGMENT_SHADER, sf::Shader::Type::Fragment))
+        {
+            cerr << "- Warning: SDF text is not available (no shader support), drawing plain text instead.\n";
+            return false;
+        }
+        shader.setUniform("texture", sf::Shader::CurrentTexture);
+        return true;
+    }();
+    return ready ? &shader : nullptr;
+}
+
+
+//----------------------------------------------------------------------------
+SdfFont::SdfFont():
+    m_size(ATLAS_WIDTH, ATLAS_INITIAL_HEIGHT)
+{
+    // White, transparent (the color comes from the vertices, the distance from alpha)
+    m_pixels.resize((size_t)m_size.x * m_size.y * 4);
+    for (size_t i = 0; i < m_pixels.size(); i += 4)
+        m_pixels[i] = m_pixels[i + 1] = m_pixels[i + 2] = 255, m_pixels[i + 3] = 0;
+
+    // A solid block at the top left corner (see getSolidTexel())
+    for (unsigned y = 0; y < 3; ++y)
+        for (unsigned x = 0; x < 3; ++x)
+            m_pixels[(y * m_size.x + x) * 4 + 3] = 255;
+    m_penX = 3 + GAP;
+    m_shelfHeight = 3;
+    m_dirtyBottom = m_size.y; // (The texture is created on the first upload.)
+}
+
+
+#ifdef SFW_SDF_TEXT
+SdfFont::~SdfFont()
+{
+    if (m_face) FT_Done_Face(m_face);
+    if (m_library) FT_Done_FreeType(m_library);
+}
+
+
+bool SdfFont::open(const std::string& filename)
+{
+    if (FT_Init_FreeType(&m_library) != 0)
+    {
+        m_library = nullptr;
+        return false;
+    }
+    if (FT_New_Face(m_library, filename.c_str(), 0, &m_face) != 0)
+    {
+        m_face = nullptr;
+        return false;
+    }
+    // Unicode code points, outlines (SFML's default charmap selection is the same)
+    if (FT_Select_Charmap(m_face, FT_ENCODING_UNICODE) != 0 || !FT_IS_SCALABLE(m_face)
+        || FT_Set_Pixel_Sizes(m_face, 0, BASE_SIZE) != 0)
+        return false;
+
+    m_unitScale = (float)BASE_SIZE / (float)m_face->units_per_EM;
+    m_lineSpacing = (float)m_face->height * m_unitScale;
+    m_underlinePosition = -(float)m_face->underline_position * m_unitScale;
+    m_underlineThickness = (float)m_face->underline_thickness * m_unitScale;
+    return true;
+}
+#else // No FreeType: no atlas can be made (see load())
+SdfFont::~SdfFont() = default;
+bool SdfFont::open(const std::string&) { return false; }
+#endif
+
+
+const SdfFont::Glyph& SdfFont::getGlyph(std::uint32_t codePoint, bool bold)
+{
+    std::uint64_t k = key(codePoint, bold);
+    if (auto it = m_glyphs.find(k); it != m_glyphs.end())
+        return it->second;
+
+    AllocationGuard::Pause exempt; // New content
+    Glyph& glyph = m_glyphs[k];
+    render(codePoint, bold, glyph);
+    return glyph;
+}
+
+
+#ifdef SFW_SDF_TEXT
+float SdfFont::getKerning(std::uint32_t first, std::uint32_t second) const
+{
+    if (!first || !second || !FT_HAS_KERNING(m_face))
+        return 0;
+
+    FT_Vector kerning;
+    if (FT_Get_Kerning(m_face, FT_Get_Char_Index(m_face, first), FT_Get_Char_Index(m_face, second),
+                       FT_KERNING_UNSCALED, &kerning) != 0)
+        return 0;
+    return (float)kerning.x * m_unitScale;
+}
+#else
+float SdfFont::getKerning(std::uint32_t, std::uint32_t) const { return 0; }
+#endif
+
+
+const sf::Texture& SdfFont::getTexture()
+{
+    if constexpr (!Renderer::headless)
+    {
+        if (m_dirtyBottom > m_dirtyTop)
+        {
+            if (m_texture.getSize() != m_size) // First use, or the atlas has grown
+            {
+                if (!m_texture.create(m_size))
+                    cerr << "- ERROR: Failed to create the SDF glyph atlas!\n";
+                m_texture.setSmooth(true); // The distances must be interpolated
+                m_dirtyTop = 0;
+                m_dirtyBottom = m_size.y;
+            }
+            m_texture.update(m_pixels.data() + (size_t)m_dirtyTop * m_size.x * 4,
+                             {m_size.x, m_dirtyBottom - m_dirtyTop}, {0, m_dirtyTop});
+            m_dirtyTop = m_dirtyBottom = 0;
+        }
+    }
+    return m_texture;
+}
+
+
+#ifdef SFW_SDF_TEXT
+void SdfFont::render(std::uint32_t codePoint, bool bold, Glyph& sdf)
+{
+    // The outline, unhinted (hinting is for the pixel grid of one size only)
+    if (FT_Load_Char(m_face, codePoint, FT_LOAD_NO_BITMAP | FT_LOAD_NO_HINTING) != 0)
+        return;
+    FT_GlyphSlot slot = m_face->glyph;
+    sdf.advance = (float)slot->linearHoriAdvance / 65536.f; // (16.16, at BASE_SIZE)
+    if (bold && slot->format == FT_GLYPH_FORMAT_OUTLINE)
+    {
+        FT_Outline_Embolden(&slot->outline, 1 << 6); // 1 pixel, like SFML
+        sdf.advance += 1;
+    }
+    if (FT_Render_Glyph(slot, FT_RENDER_MODE_NORMAL) != 0)
+        return;
+    const FT_Bitmap& bitmap = slot->bitmap;
+    int bw = (int)bitmap.width, bh = (int)bitmap.rows;
+    if (bw <= 0 || bh <= 0 || !bitmap.buffer)
+        return; // E.g. a space
+
+    // The bitmap, thresholded, with SPREAD margins around it
+    int w = bw + 2 * (int)SPREAD, h = bh + 2 * (int)SPREAD;
+    std::vector<float> outside((size_t)w * h, FAR), inside((size_t)w * h, 0); // Squared distances to the nearest inside/outside pixel
+    for (int y = 0; y < bh; ++y)
+        for (int x = 0; x < bw; ++x)
+            if (bitmap.buffer[y * bitmap.pitch + x] >= 128)
+            {
+                size_t i = (size_t)(y + (int)SPREAD) * w + (size_t)(x + (int)SPREAD);
+                outside[i] = 0;
+                inside[i] = FAR;
+            }
+    distance2D(outside, w, h);
+    distance2D(inside, w, h);
+
+    sf::Vector2u pos;
+    if (!reserve({(unsigned)w, (unsigned)h}, pos))
+    {
+        cerr << "- ERROR: The SDF glyph atlas is full!\n";
+        return;
+    }
+
+    // Signed distance from the edge (which is half a pixel from the pixel
+    // centers on either side), mapped to 0..1, with 0.5 at the edge
+    for (int y = 0; y < h; ++y)
+        for (int x = 0; x < w; ++x)
+        {
+            size_t i = (size_t)y * w + x;
+            float d = outside[i] > 0 ? std::sqrt(outside[i]) - 0.5f : 0.5f - std::sqrt(inside[i]);
+            float value = std::clamp(0.5f - d / (2 * (float)SPREAD), 0.f, 1.f);
+            m_pixels[((size_t)(pos.y + y) * m_size.x + pos.x + x) * 4 + 3] = (std::uint8_t)std::lround(value * 255);
+        }
+    if (m_dirtyBottom > m_dirtyTop)
+    {
+        m_dirtyTop = min(m_dirtyTop, pos.y);
+        m_dirtyBottom = max(m_dirtyBottom, pos.y + h);
+    }
+    else
+    {
+        m_dirtyTop = pos.y;
+        m_dirtyBottom = pos.y + h;
+    }
+
+    sdf.bounds = {{(float)slot->bitmap_left, -(float)slot->bitmap_top}, {(float)bw, (float)bh}};
+    sdf.quadBounds = {{sdf.bounds.left - (float)SPREAD, sdf.bounds.top - (float)SPREAD},
+                      {(float)w, (float)h}};
+    sdf.textureRect = {{(float)pos.x, (float)pos.y}, {(float)w, (float)h}};
+}
+#else
+void SdfFont::render(std::uint32_t, bool, Glyph&) {}
+#endif
+
+
+bool SdfFont::reserve(sf::Vector2u size, sf::Vector2u& position)
+{
+    if (size.x > m_size.x)
+        return false;
+
+    // Start a new shelf, if it doesn't fit in the current one
+    if (m_penX + size.x > m_size.x)
+    {
+        m_shelfTop += m_shelfHeight + GAP;
+        m_shelfHeight = 0;
+        m_penX = 0;
+    }
+    // (The current shelf is always the last one, so it can just grow taller.)
+    m_shelfHeight = max(m_shelfHeight, size.y);
+
+    // Grow the atlas, if needed (the existing texture coords. stay valid, as
+    // they're in pixels, and the width doesn't change; the texture is remade
+    // on the next upload, see getTexture())
+    if (m_shelfTop + m_shelfHeight > m_size.y)
+    {
+        unsigned height = m_size.y;
+        while (m_shelfTop + m_shelfHeight > height) height *= 2;
+        if (height > ATLAS_MAX_HEIGHT)
+            return false;
+
+        m_pixels.resize((size_t)m_size.x * height * 4);
+        for (size_t i = (size_t)m_size.x * m_size.y * 4; i < m_pixels.size(); i += 4)
+            m_pixels[i] = m_pixels[i + 1] = m_pixels[i + 2] = 255, m_pixels[i + 3] = 0;
+        m_size.y = height;
+    }
+
+    position = {m_penX, m_shelfTop};
+    m_penX += size.x + GAP;
+    return true;
+}
+
+} // namespace gfx
+} // namespace sfw
@@ -1,5 +1,6 @@
 #include "sfw/Gfx/Shapes/Arrow.hpp"
 #include "sfw/Theme.hpp"
+#include "sfw/Gfx/Render.hpp"
 
 #include <SFML/Graphics/RenderTarget.hpp>
 
@@ -65,6 +66,14 @@ void Arrow::draw(sf::RenderTarget& target, const sf::RenderStates& states) const
 }
 
 
+void Arrow::draw(gfx::Renderer& renderer, const sf::RenderStates& states) const
+{
+    auto lstates = states;
+    lstates.texture = &Theme::getTexture();
+    renderer.draw(m_vertices, 4, sf::PrimitiveType::TriangleStrip, lstates);
+}
+
+
 void Arrow::updateGeometry(float x, float y, Direction direction)
 {
     const sf::IntRect& rect = Theme::getArrowTextureRect();
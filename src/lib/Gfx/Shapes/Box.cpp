@@ -1,10 +1,10 @@
 #include "sfw/Gfx/Shapes/Box.hpp"
 #include "sfw/Theme.hpp"
+#include "sfw/Gfx/Render.hpp"
+#include "sfw/Gfx/TextLayout.hpp"
 
 #include <SFML/Graphics/RenderTarget.hpp>
-#include <SFML/Graphics/RectangleShape.hpp>
 
-#include <cassert>
 #include <cmath>
 
 namespace sfw
@@ -21,19 +21,14 @@ Box::Box(Type type):
 
 const sf::Vector2f& Box::getPosition() const
 {
-    return m_vertices[TOP_LEFT].position;
+    return m_position;
 }
 
 
 void Box::setPosition(float x, float y)
 {
     // OpenGL will render things kinda funny otherwise:
-    x = roundf(x);
-    y = roundf(y);
-
-    sf::Vector2f diff = sf::Vector2f(x, y) - getPosition();
-    for (size_t i = 0; i < VERTEX_COUNT; ++i)
-        m_vertices[i].position += diff;
+    m_position = {roundf(x), roundf(y)};
 }
 
 
@@ -43,32 +38,12 @@ void Box::setSize(float width, float height)
         return;
 
     // OpenGL will render things kinda funny otherwise:
-    width = roundf(width);
-    height = roundf(height);
-
-    // Move/resize each of the 9 slices
-    // 0--x1--x2--x3
-    // |   |   |   |
-    // y1--+---+---+
-    // |   |   |   |
-    // y2--+---+---+
-    // |   |   |   |
-    // y3--+---+---+
-    float x1 =   (float)Theme::borderSize;
-    float x2 = width -  Theme::borderSize;
-    float x3 = width;
-    float y1 =   (float)Theme::borderSize;
-    float y2 = height - Theme::borderSize;
-    float y3 = height;
-    setSegmentGeometry(TOP_SEGMENT,    0, x1, x2, x3,  0, y1);
-    setSegmentGeometry(MIDDLE_SEGMENT, 0, x1, x2, x3, y1, y2);
-    setSegmentGeometry(BOTTOM_SEGMENT, 0, x1, x2, x3, y2, y3);
+    m_size = {roundf(width), roundf(height)};
 }
 
 sf::Vector2f Box::getSize() const
 {
-    // Bottom right corner - top left corner
-    return m_vertices[BOTTOM_RIGHT].position - getPosition();
+    return m_size;
 }
 
 
@@ -91,38 +66,8 @@ void Box::release()
 
 bool Box::containsPoint(float x, float y) const
 {
-    return x > m_vertices[TOP_LEFT].position.x && x < m_vertices[BOTTOM_RIGHT].position.x
-        && y > m_vertices[TOP_LEFT].position.y && y < m_vertices[BOTTOM_RIGHT].position.y;
-}
-
-
-void Box::setSegmentGeometry(StripSegment n, float x0, float x2, float x4, float x6, float top, float bottom)
-{
-    size_t index = n * VERTICES_PER_SEGMENT;
-    m_vertices[index++].position = sf::Vector2f(x0, top);
-    m_vertices[index++].position = sf::Vector2f(x0, bottom);
-    m_vertices[index++].position = sf::Vector2f(x2, top);
-    m_vertices[index++].position = sf::Vector2f(x2, bottom);
-    m_vertices[index++].position = sf::Vector2f(x4, top);
-    m_vertices[index++].position = sf::Vector2f(x4, bottom);
-    m_vertices[index++].position = sf::Vector2f(x6, top);
-    m_vertices[index++].position = sf::Vector2f(x6, bottom);
-    // Extra dummy vertex for "carriage-return"
-    m_vertices[index].position = m_vertices[index - 1].position;
-    assert(index == n * VERTICES_PER_SEGMENT + VERTICES_PER_SEGMENT - 1);
-}
-
-void Box::setSegmentTextureCoords(StripSegment n, float txleft, float txtop, float txwidth, float txheight)
-{
-    size_t index = n * VERTICES_PER_SEGMENT;
-    for (size_t x = 0; x <= 3; ++x)
-    {
-        m_vertices[index++].texCoords = sf::Vector2f(txleft + txwidth * x, txtop);
-        m_vertices[index++].texCoords = sf::Vector2f(txleft + txwidth * x, txtop + txheight);
-    }
-    // Extra dummy vertex for "carriage-return":
-    m_vertices[index].texCoords = m_vertices[index - 1].texCoords;
-    assert(index == n * VERTICES_PER_SEGMENT + VERTICES_PER_SEGMENT - 1);
+    return x > m_position.x && x < m_position.x + m_size.x
+        && y > m_position.y && y < m_position.y + m_size.y;
 }
 
 
@@ -133,15 +78,6 @@ void Box::applyState(WidgetState state)
     if (state == m_state || (state == WidgetState::Hovered && m_state == WidgetState::Focused))
         return;
 
-    sf::FloatRect subrect = (sf::FloatRect)Theme::getTextureRect(m_type, state);
-    float x = subrect.left;
-    float y = subrect.top;
-    float width = (float)Theme::borderSize;
-    float height = (float)Theme::borderSize;
-    setSegmentTextureCoords(TOP_SEGMENT,    x, y, width, height);
-    setSegmentTextureCoords(MIDDLE_SEGMENT, x, y + height, width, height);
-    setSegmentTextureCoords(BOTTOM_SEGMENT, x, y + height * 2, width, height);
-
     if (m_state == WidgetState::Pressed) // Any state change happens to cancel the "Pressed" state!
     {
         onRelease();
@@ -156,18 +92,48 @@ void Box::applyState(WidgetState state)
 
 void Box::draw(sf::RenderTarget& target, const sf::RenderStates& states) const
 {
+    sf::Vertex vertices[gfx::Renderer::NINE_SLICE_VERTICES];
+    size_t count = gfx::Renderer::nineSlice(vertices, {m_position, m_size}, (float)Theme::borderSize,
+                                            (sf::Vector2f)Theme::getTextureRect(m_type, m_state).getPosition());
     auto lstates = states;
     lstates.texture = &Theme::getTexture();
-    target.draw(m_vertices, VERTEX_COUNT, sf::PrimitiveType::TriangleStrip, lstates);
+    target.draw(vertices, count, sf::PrimitiveType::Triangles, lstates);
+    // Override the texture with a filled rect (presumably with some alpha) if fillColor was set:
+    if (m_fillColor)
+    {
+        fillInnerRect(target, m_fillColor.value(), states);
+    }
+}
+
+
+void Box::fillInnerRect(sf::RenderTarget& target, sf::Color color, const sf::RenderStates& states) const
+{
+    float left   = getPosition().x + (float)Theme::borderSize;
+    float top    = getPosition().y + (float)Theme::borderSize;
+    float right  = getPosition().x + getSize().x - (float)Theme::borderSize;
+    float bottom = getPosition().y + getSize().y - (float)Theme::borderSize;
+    const sf::Vertex quad[4] = {
+        {{left,  top},    color},
+        {{left,  bottom}, color},
+        {{right, top},    color},
+        {{right, bottom}, color},
+    };
+    auto lstates = states;
+    lstates.texture = nullptr;
+    target.draw(quad, 4, sf::PrimitiveType::TriangleStrip, lstates);
+}
+
+
+void Box::draw(gfx::Renderer& renderer, const sf::RenderStates& states) const
+{
+    renderer.drawNineSlice({m_position, m_size}, (float)Theme::borderSize,
+                           (sf::Vector2f)Theme::getTextureRect(m_type, m_state).getPosition(),
+                           Theme::getTexture(), states);
     // Override the texture with a filled rect (presumably with some alpha) if fillColor was set:
     if (m_fillColor)
     {
-        sf::RectangleShape r(sf::Vector2f(getSize().x - 2 * (float)Theme::borderSize,
-                                          getSize().y - 2 * (float)Theme::borderSize));
-	r.setPosition(getPosition()); r.move({(float)Theme::borderSize, (float)Theme::borderSize});
-	r.setFillColor(m_fillColor.value());
-	r.setOutlineThickness(0);
-	target.draw(r, lstates);
+        sf::Vector2f border((float)Theme::borderSize, (float)Theme::borderSize);
+        renderer.fillRect({getPosition() + border, getSize() - border * 2.f}, m_fillColor.value(), states);
     }
 }
 
@@ -175,7 +141,7 @@ void Box::draw(sf::RenderTarget& target, const sf::RenderStates& states) const
 void Box::centerTextHorizontally(sf::Text& text)
 {
     sf::Vector2f size = getSize();
-    sf::FloatRect textSize = text.getLocalBounds();
+    sf::FloatRect textSize = gfx::textBounds(text);
     float x = roundf(getPosition().x + (size.x - textSize.width) / 2);
     text.setPosition({x, Theme::borderSize + Theme::PADDING});
 }
@@ -184,7 +150,7 @@ void Box::centerTextHorizontally(sf::Text& text)
 void Box::centerVerticalTextVertically(sf::Text& text)
 {
     sf::Vector2f size = getSize();
-    sf::FloatRect textSize = text.getLocalBounds();
+    sf::FloatRect textSize = gfx::textBounds(text);
     float y = roundf(getPosition().y + (size.y - textSize.width) / 2);
     text.setPosition({Theme::getBoxHeight() - Theme::PADDING, y});
 }
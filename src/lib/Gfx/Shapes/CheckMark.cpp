@@ -1,5 +1,6 @@
 #include "sfw/Gfx/Shapes/CheckMark.hpp"
 #include "sfw/Theme.hpp"
+#include "sfw/Gfx/Render.hpp"
 
 #include <SFML/System/Vector2.hpp>
 #include <SFML/Graphics/Vertex.hpp>
@@ -68,6 +69,14 @@ void CheckMark::draw(sf::RenderTarget& target, const sf::RenderStates& states) c
 }
 
 
+void CheckMark::draw(gfx::Renderer& renderer, const sf::RenderStates& states) const
+{
+    auto lstates = states;
+    lstates.texture = &Theme::getTexture();
+    renderer.draw(m_vertices, 4, sf::PrimitiveType::TriangleStrip, lstates);
+}
+
+
 void CheckMark::updateGeometry(float x, float y)
 {
     const sf::IntRect& rect = Theme::getCheckMarkTextureRect();
@@ -0,0 +1,149 @@
+#include "sfw/Gfx/TextLayout.hpp"
+
+#include <algorithm>
+    using std::min, std::max;
+
+namespace sfw
+{
+namespace gfx
+{
+
+//============================================================================
+SdfFont* TextLayout::fontOf(const sf::Text& text)
+{
+    const sf::Font* font = text.getFont();
+    if (!font || text.getOutlineThickness() != 0)
+        return nullptr;
+    return SdfFont::forText(*font);
+}
+
+
+TextLayout::TextLayout(const sf::Text& text, SdfFont& font):
+    m_string(text.getString()),
+    m_font(font),
+    m_bold(text.getStyle() & sf::Text::Bold),
+    m_scale((float)text.getCharacterSize() / (float)SdfFont::BASE_SIZE),
+    m_pen(0, (float)text.getCharacterSize())
+{
+    const SdfFont::Glyph& x = m_font.getGlyph(U'x', m_bold);
+    m_strikeThroughOffset = (x.bounds.top + x.bounds.height / 2.f) * m_scale;
+    m_whitespaceWidth = m_font.getGlyph(U' ', m_bold).advance * m_scale;
+    m_letterSpacing = (m_whitespaceWidth / 3.f) * (text.getLetterSpacing() - 1.f);
+    m_whitespaceWidth += m_letterSpacing;
+    m_lineSpacing = m_font.getLineSpacing() * m_scale * text.getLineSpacing();
+}
+
+
+bool TextLayout::next()
+{
+    m_pen = penAfter();
+    m_prev = m_char;
+    m_glyph = nullptr;
+    m_advance = 0;
+
+    std::size_t size = m_string.getSize();
+    while (++m_index < size && m_string[m_index] == U'\r') {}
+    if (m_index >= size)
+    {
+        m_index = size;
+        m_char = 0;
+        return false;
+    }
+
+    m_char = m_string[m_index];
+    m_pen.x += m_font.getKerning(m_prev, m_char) * m_scale;
+    switch (m_char)
+    {
+    case U' ':  m_advance = m_whitespaceWidth; break;
+    case U'\t': m_advance = m_whitespaceWidth * 4; break;
+    case U'\n': break;
+    default:
+        m_glyph = &m_font.getGlyph(m_char, m_bold);
+        m_advance = m_glyph->advance * m_scale + m_letterSpacing;
+    }
+    return true;
+}
+
+
+sf::Vector2f TextLayout::penAfter() const
+{
+    return m_char == U'\n' ? sf::Vector2f(0, m_pen.y + m_lineSpacing)
+                           : sf::Vector2f(m_pen.x + m_advance, m_pen.y);
+}
+
+
+sf::FloatRect TextLayout::bounds() const
+{
+    return m_glyph ? sf::FloatRect(m_glyph->bounds.getPosition() * m_scale, m_glyph->bounds.getSize() * m_scale)
+                   : sf::FloatRect();
+}
+
+
+sf::FloatRect TextLayout::quadBounds() const
+{
+    return m_glyph ? sf::FloatRect(m_glyph->quadBounds.getPosition() * m_scale, m_glyph->quadBounds.getSize() * m_scale)
+                   : sf::FloatRect();
+}
+
+
+//============================================================================
+sf::FloatRect textBounds(const sf::Text& text)
+{
+    SdfFont* sdf = TextLayout::fontOf(text);
+    if (!sdf)
+        return text.getLocalBounds();
+    if (text.getString().isEmpty())
+        return {};
+
+    // The same extents as sf::Text's (i.e. of the glyph outlines, and the whitespace)
+    float italicShear = (text.getStyle() & sf::Text::Italic) ? 0.209f : 0.f;
+    float minX = (float)text.getCharacterSize(), minY = minX;
+    float maxX = 0, maxY = 0;
+    TextLayout layout(text, *sdf);
+    while (layout.next())
+    {
+        sf::Vector2f pen = layout.pen();
+        if (layout.glyph())
+        {
+            sf::FloatRect b = layout.bounds();
+            minX = min(minX, pen.x + b.left - italicShear * (b.top + b.height));
+            maxX = max(maxX, pen.x + b.left + b.width - italicShear * b.top);
+            minY = min(minY, pen.y + b.top);
+            maxY = max(maxY, pen.y + b.top + b.height);
+        }
+        else
+        {
+            sf::Vector2f after = layout.penAfter();
+            minX = min(minX, pen.x);
+            minY = min(minY, pen.y);
+            maxX = max(maxX, after.x);
+            maxY = max(maxY, after.y);
+        }
+    }
+    return {{minX, minY}, {maxX - minX, maxY - minY}};
+}
+
+
+sf::Vector2f findCharacterPos(const sf::Text& text, std::size_t index)
+{
+    SdfFont* sdf = TextLayout::fontOf(text);
+    if (!sdf)
+        return text.findCharacterPos(index);
+
+    TextLayout layout(text, *sdf);
+    while (layout.next() && layout.index() < index) {}
+    // (The pen is on the baseline, the position is the top of the line.)
+    sf::Vector2f pos = layout.pen() - sf::Vector2f(0, (float)text.getCharacterSize());
+    return text.getTransform().transformPoint(pos);
+}
+
+
+float lineSpacing(const sf::Font& font, unsigned characterSize)
+{
+    if (SdfFont* sdf = SdfFont::forText(font))
+        return sdf->getLineSpacing() * (float)characterSize / (float)SdfFont::BASE_SIZE;
+    return font.getLineSpacing(characterSize);
+}
+
+} // namespace gfx
+} // namespace sfw
@@ -2,6 +2,10 @@
 #include "sfw/Theme.hpp"
 #include "sfw/Gfx/Render.hpp"
 
+#include "sfw/util/alloc_guard.hpp"
+
+#include <algorithm>
+
 #ifdef DEBUG
 #   include "sfw/GUI-main.hpp"
 #   include <iostream>
@@ -23,26 +27,74 @@ Layout::Layout():
 {
 }
 
+
+// Offscreen cache -----------------------------------------------------------
+
+Layout* Layout::setCaching(bool enable)
+{
+    m_caching = enable;
+    if (!enable) m_cache.release(); // Give the memory back
+    m_cache.invalidate();
+    invalidate(); // Not really a visual change, but better safe than sorry
+    return this;
+}
+
+
+Layout* Layout::setClipping(bool enable)
+{
+    m_clipping = enable;
+    invalidate();
+    return this;
+}
+
+
+bool Layout::isCacheValid() const
+{
+    return m_cache.valid();
+}
+
+
+bool Layout::drawCached(const gfx::RenderContext& ctx) const
+{
+    auto sfml_renderstates = ctx.props;
+    sfml_renderstates.transform *= getTransform();
+
+    return m_cache.draw(ctx, sfml_renderstates, getSize(), [this](const gfx::RenderContext& cctx) {
+        drawChildren(cctx);
+    });
+}
+
+
 // Overrides -----------------------------------------------------------------
 
 void Layout::draw(const gfx::RenderContext& ctx) const
 {
+    // (No point in caching if the drawing doesn't even go to the target.)
+    if (m_caching && ctx.renderer.submitting() && drawCached(ctx))
+        return;
+
     auto sfml_renderstates = ctx.props;
     sfml_renderstates.transform *= getTransform();
-    gfx::RenderContext lctx{ctx.target, sfml_renderstates};
+    // (The cache above needs no clipping: it's only as large as the layout.)
+    if (m_clipping) ctx.pushClip({{0, 0}, getSize()}, sfml_renderstates);
+    drawChildren(gfx::RenderContext{ctx.target, sfml_renderstates, ctx.renderer});
+    if (m_clipping) ctx.popClip();
+}
+
 
+void Layout::drawChildren(const gfx::RenderContext& lctx) const
+{
 #ifdef DEBUG
 	if (DEBUG_INSIGHT_KEY_PRESSED && m_state == WidgetState::Hovered) {
 		if (auto* root = getMain(); root) {
 //cerr << getAbsolutePosition().x << ", " << getAbsolutePosition().y << endl;
-			root->draw_outline(ctx, sf::Color::Yellow);
+			root->draw_outline(lctx, sf::Color::Yellow);
 		}
 		draw_outline(lctx, sf::Color::White);
 	}
 #endif
 
-    for (const Widget* widget = begin(); widget != end(); widget = next(widget))
-    {
+    auto drawChild = [&](const Widget* widget) {
         widget->draw(lctx);
 #ifdef DEBUG
 	if (DEBUG_INSIGHT_KEY_PRESSED && widget->m_state == WidgetState::Hovered) {
@@ -52,10 +104,61 @@ void Layout::draw(const gfx::RenderContext& ctx) const
 		}
 	}
 #endif
+    };
+
+    // Skip the children (i.e. whole subtrees) entirely out of sight (outside
+    // the window, or the current clip rect, or the area being repainted)
+    sf::FloatRect visible = lctx.renderer.clipArea(lctx.props.transform);
+
+    // If they don't overlap (so the drawing order doesn't matter), only those
+    // within reach of the visible range along the index axis are looked at
+    // (see HitIndex), the same way as for hit-testing; otherwise all of them
+    // are checked, in order
+    if (!m_hitIndex.valid)
+        buildHitIndex();
+    if (m_hitIndex.disjoint && !m_hitIndex.unsized)
+    {
+        const auto& entries = m_hitIndex.entries;
+        float lo = m_hitIndex.vertical ? visible.top : visible.left;
+        float hi = lo + (m_hitIndex.vertical ? visible.height : visible.width);
+        auto it = std::upper_bound(entries.begin(), entries.end(), lo - m_hitIndex.maxLength,
+            [](float value, const HitIndex::Entry& e) { return value < e.start; });
+        for (; it != entries.end() && it->start < hi; ++it)
+            if (mayBeVisible(it->widget, visible))
+                drawChild(it->widget);
+    }
+    else
+    {
+        for (const Widget* widget = begin(); widget != end(); widget = next(widget))
+            if (mayBeVisible(widget, visible))
+                drawChild(widget);
     }
 }
 
 
+bool Layout::mayBeVisible(const Widget* child, const sf::FloatRect& visible)
+{
+    // (Without a size, the extent is unknown: e.g. a DrawHost sizing itself
+    // to what it draws.)
+    const sf::Vector2f& size = child->getSize();
+    return size.x <= 0 || size.y <= 0 || visible.findIntersection({child->getPosition(), size});
+}
+
+
+bool Layout::updateSize(const sf::Vector2f& contentSize)
+{
+    if (!isRoot() && getParent()->arrangesChildren())
+    {
+        setPreferredSize(contentSize);
+        return false;
+    }
+
+    sf::Vector2f old_size = getSize();
+    Widget::setSize(contentSize);
+    return getSize() != old_size;
+}
+
+
 void Layout::onStateChanged(WidgetState state)
 {
     if (state == WidgetState::Default)
@@ -83,36 +186,34 @@ void Layout::onMouseMoved(float x, float y)
     }
     else
     {
-        // Loop over widgets
-        for (Widget* widget = begin(); widget != end(); widget = next(widget))
+        // Nothing can be hit where the children are clipped out (see setClipping())
+        Widget* widget = !m_clipping || containsPoint({x, y}) ? childAt({x, y}) : nullptr;
+        if (widget)
         {
             // Convert mouse position to the widget's coordinate system
             sf::Vector2f mouse = sf::Vector2f(x, y) - widget->getPosition();
-            if (widget->containsPoint(mouse))
+            if (m_hover != widget)
             {
-                if (m_hover != widget)
+                // A new widget is hovered
+                if (m_hover)
                 {
-                    // A new widget is hovered
-                    if (m_hover)
-                    {
-                        m_hover->setState(m_focus == m_hover ? WidgetState::Focused : WidgetState::Default);
-                        m_hover->onMouseLeave();
-                    }
-
-                    m_hover = widget;
-                    // Don't set the Hovered state if the widget is already focused
-                    if (m_hover != m_focus)
-                    {
-                        widget->setState(WidgetState::Hovered);
-                    }
-                    widget->onMouseEnter();
+                    m_hover->setState(m_focus == m_hover ? WidgetState::Focused : WidgetState::Default);
+                    m_hover->onMouseLeave();
                 }
-                else
+
+                m_hover = widget;
+                // Don't set the Hovered state if the widget is already focused
+                if (m_hover != m_focus)
                 {
-                    widget->onMouseMoved(mouse.x, mouse.y);
+                    widget->setState(WidgetState::Hovered);
                 }
-                return;
+                widget->onMouseEnter();
+            }
+            else
+            {
+                widget->onMouseMoved(mouse.x, mouse.y);
             }
+            return;
         }
         // No widget hovered, remove hovered state
         if (m_hover)
@@ -126,6 +227,100 @@ void Layout::onMouseMoved(float x, float y)
 }
 
 
+Widget* Layout::childAt(const sf::Vector2f& point) const
+{
+    if (!m_hitIndex.valid)
+        buildHitIndex();
+
+    // Still in the same one?
+    if (m_hover && m_hitIndex.disjoint && m_hover->containsPoint(point - m_hover->getPosition()))
+        return m_hover;
+
+    const auto& entries = m_hitIndex.entries;
+    float p = m_hitIndex.vertical ? point.y : point.x;
+
+    // The last one starting before the point, then back as far as any
+    // could still reach it
+    auto it = std::upper_bound(entries.begin(), entries.end(), p,
+        [](float value, const HitIndex::Entry& e) { return value < e.start; });
+    Widget* hit = nullptr;
+    size_t hit_order = (size_t)-1;
+    while (it != entries.begin())
+    {
+        --it;
+        if (it->start <= p - m_hitIndex.maxLength) break;
+        if (it->order < hit_order && it->widget->containsPoint(point - it->widget->getPosition()))
+        {
+            hit = it->widget;
+            hit_order = it->order;
+            if (m_hitIndex.disjoint) break; // Can't be another one
+        }
+    }
+    return hit;
+}
+
+
+void Layout::buildHitIndex() const
+{
+    auto& index = m_hitIndex;
+    index.entries.clear();
+    index.unsized = false;
+
+    // Pick the axis the children overlap the least on (i.e. where their
+    // lengths add up to the least, relative to the extent they cover)
+    float lo[2] = {0, 0}, hi[2] = {0, 0}, sum[2] = {0, 0};
+    size_t order = 0;
+    for (Widget* w = begin(); w != end(); w = next(w), ++order)
+    {
+        const auto& pos = w->getPosition();
+        const auto& size = w->getSize();
+        if (!order) { lo[0] = pos.x; lo[1] = pos.y; hi[0] = pos.x; hi[1] = pos.y; }
+        lo[0] = std::min(lo[0], pos.x);          lo[1] = std::min(lo[1], pos.y);
+        hi[0] = std::max(hi[0], pos.x + size.x); hi[1] = std::max(hi[1], pos.y + size.y);
+        sum[0] += size.x; sum[1] += size.y;
+        if (size.x <= 0 || size.y <= 0) index.unsized = true;
+    }
+    if (index.entries.capacity() < order)
+    {
+        AllocationGuard::Pause exempt; // (Also built while drawing, see drawChildren().)
+        index.entries.reserve(order);
+    }
+    auto density = [&](int axis) { return hi[axis] > lo[axis] ? sum[axis] / (hi[axis] - lo[axis]) : 0.f; };
+    index.vertical = density(1) < density(0);
+
+    index.maxLength = 0;
+    order = 0;
+    for (Widget* w = begin(); w != end(); w = next(w), ++order)
+    {
+        float start = index.vertical ? w->getPosition().y : w->getPosition().x;
+        index.maxLength = std::max(index.maxLength, index.vertical ? w->getSize().y : w->getSize().x);
+        index.entries.push_back({start, order, w});
+    }
+    std::stable_sort(index.entries.begin(), index.entries.end(),
+        [](const HitIndex::Entry& a, const HitIndex::Entry& b) { return a.start < b.start; });
+
+    // Do any of them overlap? (Checking only those within reach, as above.)
+    index.disjoint = true;
+    for (size_t i = 0; i < index.entries.size() && index.disjoint; ++i)
+    {
+        const Widget* a = index.entries[i].widget;
+        sf::FloatRect ra(a->getPosition(), a->getSize());
+        for (size_t j = i; j-- > 0;)
+        {
+            if (index.entries[j].start <= index.entries[i].start - index.maxLength) break;
+            const Widget* b = index.entries[j].widget;
+            if (ra.findIntersection(sf::FloatRect(b->getPosition(), b->getSize())))
+            {
+                index.disjoint = false;
+                break;
+            }
+        }
+    }
+
+    index.valid = true;
+}
+
+
 void Layout::onMousePressed(float x, float y)
 {
     if (m_hover)
@@ -0,0 +1,194 @@
+#include "sfw/Layouts/ConstraintLayout.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+    using std::max;
+#include <iostream>
+    using std::cerr;
+
+namespace sfw
+{
+using namespace cassowary;
+
+
+ConstraintLayout::ConstraintLayout()
+{
+    m_self = {m_solver.newVariable(), m_solver.newVariable(), m_solver.newVariable(), m_solver.newVariable()};
+    m_solver.add(Expression(m_self.left) == 0);
+    m_solver.add(Expression(m_self.top) == 0);
+    m_solver.add(Expression(m_self.width) >= 0);
+    m_solver.add(Expression(m_self.height) >= 0);
+    // Fit around the children (which are kept inside; see onChildAdded())
+    m_solver.add(Expression(m_self.width) == 0, strength::weak);
+    m_solver.add(Expression(m_self.height) == 0, strength::weak);
+}
+
+
+const ConstraintLayout::Anchors& ConstraintLayout::anchors(const Widget* child) const
+{
+    if (auto it = m_anchors.find(child); it != m_anchors.end())
+        return it->second;
+
+    cerr << "- ERROR: ConstraintLayout::anchors() called for a widget not in the layout!\n";
+    static const Anchors none;
+    return none;
+}
+
+
+ConstraintLayout::ConstraintId ConstraintLayout::addConstraint(const Constraint& c, double strength)
+{
+    ConstraintId id = m_solver.add(c, strength);
+    requestLayout();
+    return id;
+}
+
+
+void ConstraintLayout::removeConstraint(ConstraintId id)
+{
+    m_solver.remove(id);
+    requestLayout();
+}
+
+
+bool ConstraintLayout::addEditVariable(Variable v, double strength)
+{
+    return m_solver.addEditVariable(v, strength);
+}
+
+
+void ConstraintLayout::suggestValue(Variable v, double value)
+{
+    m_solver.suggestValue(v, value);
+    requestLayout();
+}
+
+
+ConstraintLayout* ConstraintLayout::setFixedSize(const sf::Vector2f& size)
+{
+    m_fixedSize = size;
+    suggestSize(size);
+    requestLayout();
+    return this;
+}
+
+
+void ConstraintLayout::suggestSize(const sf::Vector2f& size)
+{
+    auto suggest = [this](Variable v, float value) {
+        if (value > 0)
+        {
+            if (!m_solver.hasEditVariable(v)) m_solver.addEditVariable(v, strength::strong);
+            m_solver.suggestValue(v, value);
+        }
+        else m_solver.removeEditVariable(v);
+    };
+    suggest(m_self.width, size.x);
+    suggest(m_self.height, size.y);
+}
+
+
+void ConstraintLayout::onChildAdded(Widget* child)
+{
+    Anchors a = {m_solver.newVariable(), m_solver.newVariable(), m_solver.newVariable(), m_solver.newVariable()};
+    m_anchors[child] = a;
+
+    // Inside the layout, at its own size, and at (0, 0) by default
+    bool ok = m_solver.add(Expression(a.left) >= 0)
+           && m_solver.add(Expression(a.top) >= 0)
+           && m_solver.add(Expression(a.left) == 0, strength::weak)
+           && m_solver.add(Expression(a.top) == 0, strength::weak)
+           && m_solver.add(a.right() <= m_self.width)
+           && m_solver.add(a.bottom() <= m_self.height)
+           && m_solver.add(Expression(a.width) >= 0)
+           && m_solver.add(Expression(a.height) >= 0)
+           && m_solver.addEditVariable(a.width, strength::medium)
+           && m_solver.addEditVariable(a.height, strength::medium);
+    if (!ok)
+    {
+        // (Can't happen with a consistent solver: these only involve the new
+        // variables, and the size of the layout, which can always grow.)
+        cerr << "- ERROR: ConstraintLayout: Failed to add the default constraints of a child!\n";
+        assert(ok);
+        return;
+    }
+
+    sf::Vector2f size = child->measure();
+    m_solver.suggestValue(a.width, size.x);
+    m_solver.suggestValue(a.height, size.y);
+}
+
+
+void ConstraintLayout::onChildResized(Widget* child)
+{
+    m_resized.push_back(child);
+}
+
+
+sf::Vector2f ConstraintLayout::solvedSize() const
+{
+    // (Rounded as the widget sizes are, to compare them.)
+    return {std::round((float)max(0.0, m_solver.value(m_self.width))),
+            std::round((float)max(0.0, m_solver.value(m_self.height)))};
+}
+
+
+sf::Vector2f ConstraintLayout::computeSize(const Constraints& constraints)
+{
+    return constraints.clamp(solvedSize());
+}
+
+
+void ConstraintLayout::recomputeGeometry()
+{
+    // Only the children changed since the last time are fed to the solver
+    for (Widget* child : m_resized)
+    {
+        if (auto it = m_anchors.find(child); it != m_anchors.end())
+        {
+            sf::Vector2f size = child->measure();
+            m_solver.suggestValue(it->second.width, size.x);
+            m_solver.suggestValue(it->second.height, size.y);
+        }
+    }
+    m_resized.clear();
+    m_solver.updateVariables();
+
+    if (!updateSize(solvedSize()))
+        arrangeChildren();
+}
+
+
+void ConstraintLayout::onResized()
+{
+    arrangeChildren();
+}
+
+
+void ConstraintLayout::arrangeChildren()
+{
+    // Arranged to some other size by the parent: solve for that, but only for
+    // arranging the children, so that the layout is still measured by its
+    // content (or its fixed size), not by the last size it was arranged to
+    bool arranged = getSize() != solvedSize();
+    if (arranged)
+    {
+        suggestSize(getSize());
+        m_solver.updateVariables();
+    }
+
+    for (Widget* w = begin(); w != end(); w = next(w))
+    {
+        const Anchors& a = m_anchors[w];
+        w->arrange({{(float)m_solver.value(a.left), (float)m_solver.value(a.top)},
+                    {(float)max(0.0, m_solver.value(a.width)), (float)max(0.0, m_solver.value(a.height))}});
+    }
+
+    if (arranged)
+    {
+        suggestSize(m_fixedSize); // (Drops the edits not set by setFixedSize().)
+        m_solver.updateVariables();
+    }
+}
+
+} // namespace
@@ -0,0 +1,178 @@
+#include "sfw/Layouts/Flex.hpp"
+#include "sfw/Theme.hpp"
+
+#include <algorithm>
+    using std::min, std::max;
+
+namespace sfw
+{
+
+// The component of `v` along (main) or across (!main) the direction
+static float& along(sf::Vector2f& v, Orientation dir, bool main = true)
+{
+    return (dir == Horizontal) == main ? v.x : v.y;
+}
+
+
+Flex::Flex(Orientation direction):
+    m_direction(direction)
+{
+}
+
+
+Flex* Flex::setDirection(Orientation direction)
+{
+    m_direction = direction;
+    requestLayout();
+    return this;
+}
+
+Flex* Flex::setAlign(Align align)
+{
+    m_align = align;
+    requestLayout();
+    return this;
+}
+
+Flex* Flex::setJustify(Justify justify)
+{
+    m_justify = justify;
+    requestLayout();
+    return this;
+}
+
+Flex* Flex::setGap(float gap)
+{
+    m_gap = gap;
+    requestLayout();
+    return this;
+}
+
+Flex* Flex::setFixedSize(const sf::Vector2f& size)
+{
+    m_fixedSize = size;
+    requestLayout();
+    return this;
+}
+
+Flex* Flex::setFlex(Widget* child, float grow, float shrink, float basis)
+{
+    m_items[child] = Item{max(0.f, grow), max(0.f, shrink), basis};
+    requestLayout();
+    return this;
+}
+
+
+const Flex::Item& Flex::item(const Widget* child) const
+{
+    static const Item default_item;
+    auto it = m_items.find(child);
+    return it != m_items.end() ? it->second : default_item;
+}
+
+
+float Flex::gap() const
+{
+    return m_gap < 0 ? Theme::MARGIN : m_gap;
+}
+
+
+sf::Vector2f Flex::computeSize(const Constraints& constraints)
+{
+    // The children are always measured without limits, so that every one of
+    // them is measured only once (the measurements are cached for that), no
+    // matter how the layout itself is measured, or then arranged.
+    sf::Vector2f size{};
+    size_t n = 0;
+    for (Widget* w = begin(); w != end(); w = next(w), ++n)
+    {
+        sf::Vector2f s = w->measure();
+        const Item& it = item(w);
+        along(size, m_direction)        += it.basis < 0 ? along(s, m_direction) : it.basis;
+        along(size, m_direction, false)  = max(along(size, m_direction, false), along(s, m_direction, false));
+    }
+    if (n) along(size, m_direction) += gap() * float(n - 1);
+
+    if (m_fixedSize.x > 0) size.x = m_fixedSize.x;
+    if (m_fixedSize.y > 0) size.y = m_fixedSize.y;
+
+    return constraints.clamp(size);
+}
+
+
+void Flex::recomputeGeometry()
+{
+    if (!updateSize(measure()))
+        arrangeChildren();
+}
+
+
+void Flex::onResized()
+{
+    arrangeChildren();
+}
+
+
+void Flex::arrangeChildren()
+{
+    sf::Vector2f size = getSize();
+    const float length = along(size, m_direction);
+    const float thickness = along(size, m_direction, false);
+
+    // Collect the factors
+    size_t n = 0;
+    float total_basis = 0, total_grow = 0, total_shrink = 0;
+    for (Widget* w = begin(); w != end(); w = next(w), ++n)
+    {
+        sf::Vector2f s = w->measure(); // (Cached by computeSize().)
+        const Item& it = item(w);
+        float basis = it.basis < 0 ? along(s, m_direction) : it.basis;
+        total_basis  += basis;
+        total_grow   += it.grow;
+        total_shrink += it.shrink * basis;
+    }
+    if (!n) return;
+
+    float free = length - total_basis - gap() * float(n - 1);
+
+    // Where the free space not taken by growing goes
+    float offset = 0, spacing = gap();
+    if (free > 0 && total_grow == 0)
+    {
+        switch (m_justify)
+        {
+        case Justify::Start: break;
+        case Justify::Center: offset = free / 2; break;
+        case Justify::End: offset = free; break;
+        case Justify::SpaceBetween: if (n > 1) spacing += free / float(n - 1); break;
+        }
+    }
+
+    // Place them
+    float pos = offset;
+    for (Widget* w = begin(); w != end(); w = next(w))
+    {
+        sf::Vector2f s = w->measure();
+        const Item& it = item(w);
+        float basis = it.basis < 0 ? along(s, m_direction) : it.basis;
+
+        float len = basis;
+        if (free > 0 && total_grow > 0)         len += free * it.grow / total_grow;
+        else if (free < 0 && total_shrink > 0)  len += free * it.shrink * basis / total_shrink;
+        len = max(0.f, len);
+
+        float cross = m_align == Align::Stretch ? thickness : min(along(s, m_direction, false), thickness);
+        float cross_pos = m_align == Align::Center ? (thickness - cross) / 2
+                        : m_align == Align::End    ?  thickness - cross
+                        : 0;
+
+        sf::Vector2f p, extent;
+        along(p, m_direction) = pos;       along(p, m_direction, false) = cross_pos;
+        along(extent, m_direction) = len;  along(extent, m_direction, false) = cross;
+        w->arrange({p, extent});
+
+        pos += len + spacing;
+    }
+}
+
+} // namespace
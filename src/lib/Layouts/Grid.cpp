@@ -0,0 +1,347 @@
+#include "sfw/Layouts/Grid.hpp"
+#include "sfw/Theme.hpp"
+
+#include <vector>
+#include <tuple>
+#include <algorithm>
+    using std::min, std::max;
+
+namespace sfw
+{
+
+static constexpr size_t NONE = (size_t)-1; // For m_arrangeFrom
+
+
+Grid::Grid(size_t columns):
+    m_columns(max(columns, (size_t)1))
+{
+}
+
+
+Grid* Grid::setSpan(Widget* child, size_t columns, size_t rows)
+{
+    m_spans[child] = {max(columns, (size_t)1), max(rows, (size_t)1)};
+    m_placed = false;
+    requestLayout();
+    return this;
+}
+
+
+Grid* Grid::setColumn(size_t column, Sizing sizing, float value)
+{
+    if (column >= m_columns.size())
+        return this;
+    m_columns[column].sizing = sizing;
+    m_columns[column].value = max(0.f, value);
+    m_columns[column].changed = true;
+    m_arrangeFrom = 0; // (The Fill columns may have changed, even if the widths haven't.)
+    requestLayout();
+    return this;
+}
+
+
+Grid* Grid::setGap(float gap)
+{
+    m_gap = gap;
+    invalidateExtents();
+    requestLayout();
+    return this;
+}
+
+
+float Grid::gap() const
+{
+    return m_gap < 0 ? Theme::MARGIN : m_gap;
+}
+
+
+void Grid::onChildAdded(Widget*)
+{
+    m_placed = false;
+}
+
+
+void Grid::onChildResized(Widget* child)
+{
+    if (!m_placed) return; // Everything will be measured anyway
+
+    if (auto it = m_cellOf.find(child); it != m_cellOf.end())
+        m_changed.push_back(it->second);
+}
+
+
+void Grid::onThemeChanged()
+{
+    invalidateExtents(); // The gap may have changed
+    requestLayout();
+}
+
+
+void Grid::invalidateExtents()
+{
+    for (auto& column : m_columns) column.changed = true;
+    for (auto& row : m_rows)       row.changed = true;
+    m_arrangeFrom = 0;
+}
+
+
+void Grid::place()
+{
+    const size_t ncols = m_columns.size();
+
+    m_cells.clear();
+    m_cellOf.clear();
+    m_spanning.clear();
+    m_changed.clear();
+    m_resized.clear();
+
+    // Fill the cells row by row, skipping those covered by spans
+    std::vector<char> used; // ncols per row
+    auto is_free = [&](size_t row, size_t col, size_t rows, size_t cols) {
+        if (used.size() < (row + rows) * ncols) used.resize((row + rows) * ncols, 0);
+        for (size_t r = row; r < row + rows; ++r)
+            for (size_t c = col; c < col + cols; ++c)
+                if (used[r * ncols + c]) return false;
+        return true;
+    };
+
+    size_t row = 0, col = 0, nrows = 0;
+    for (Widget* w = begin(); w != end(); w = next(w))
+    {
+        size_t cols = 1, rows = 1;
+        if (auto it = m_spans.find(w); it != m_spans.end())
+            std::tie(cols, rows) = it->second;
+        cols = min(cols, ncols);
+
+        for (;; ++col)
+        {
+            if (col + cols > ncols) { ++row; col = 0; }
+            if (is_free(row, col, rows, cols)) break;
+        }
+        for (size_t r = row; r < row + rows; ++r)
+            for (size_t c = col; c < col + cols; ++c)
+                used[r * ncols + c] = 1;
+
+        if (rows > 1 || cols > 1) m_spanning.push_back(m_cells.size());
+        m_cellOf[w] = m_cells.size();
+        m_cells.push_back({w, row, col, rows, cols, w->measure()});
+        nrows = max(nrows, row + rows);
+        col += cols;
+    }
+
+    // (As the cells are placed row by row, they are also sorted by row.)
+    m_rows.assign(nrows, Row{});
+    size_t i = 0;
+    for (size_t r = 0; r < nrows; ++r)
+    {
+        while (i < m_cells.size() && m_cells[i].row < r) ++i;
+        m_rows[r].first = i;
+        m_rows[r].rescan = true;
+    }
+    for (auto& column : m_columns)
+    {
+        column.base = 0;
+        column.rescan = true;
+    }
+    m_colWidths.assign(m_columns.size(), 0);
+    m_rowHeights.assign(nrows, 0);
+
+    m_placed = true;
+    m_arrangeFrom = 0;
+}
+
+
+void Grid::updateExtents()
+{
+    if (!m_placed) place();
+
+    // Remeasure the changed cells
+    for (size_t i : m_changed)
+    {
+        Cell& cell = m_cells[i];
+        sf::Vector2f old_size = cell.size;
+        cell.size = cell.widget->measure();
+        if (cell.size == old_size) continue;
+
+        m_resized.push_back(i);
+        if (cell.rows == 1) m_rows[cell.row].rescan = true;
+        else                m_rows[cell.row + cell.rows - 1].changed = true;
+        if (cell.cols == 1)
+        {
+            Column& column = m_columns[cell.col];
+            if (cell.size.x >= column.base) { column.base = cell.size.x; column.changed = true; }
+            else if (old_size.x >= column.base) column.rescan = true; // Was the widest
+        }
+        else m_columns[cell.col + cell.cols - 1].changed = true;
+    }
+    m_changed.clear();
+
+    // Rescan only the affected columns and rows
+    for (size_t c = 0; c < m_columns.size(); ++c)
+    {
+        Column& column = m_columns[c];
+        if (!column.rescan) continue;
+        float base = 0;
+        for (const auto& cell : m_cells)
+            if (cell.col == c && cell.cols == 1) base = max(base, cell.size.x);
+        column.base = base;
+        column.rescan = false;
+        column.changed = true;
+    }
+    for (size_t r = 0; r < m_rows.size(); ++r)
+    {
+        Row& row = m_rows[r];
+        if (!row.rescan) continue;
+        size_t end = r + 1 < m_rows.size() ? m_rows[r + 1].first : m_cells.size();
+        float base = 0;
+        for (size_t i = row.first; i < end; ++i)
+            if (m_cells[i].rows == 1) base = max(base, m_cells[i].size.y);
+        row.base = base;
+        row.rescan = false;
+        row.changed = true;
+    }
+
+    // The final extents of the changed ones (with the spanning cells enlarging
+    // their last track, if they don't fit otherwise), in order, as a change
+    // may also affect the spans across it, and so the tracks ending those
+    const float g = gap();
+    for (size_t c = 0; c < m_columns.size(); ++c)
+    {
+        Column& column = m_columns[c];
+        if (!column.changed) continue;
+        column.changed = false;
+
+        float width = column.sizing == Sizing::Fixed ? column.value : column.base;
+        for (size_t i : m_spanning)
+        {
+            const Cell& cell = m_cells[i];
+            if (cell.cols == 1 || cell.col + cell.cols - 1 != c || column.sizing == Sizing::Fixed) continue;
+            float w = g * float(cell.cols - 1) + width;
+            for (size_t k = cell.col; k < c; ++k) w += m_colWidths[k];
+            if (cell.size.x > w) width += cell.size.x - w;
+        }
+        if (width == m_colWidths[c]) continue;
+
+        m_colWidths[c] = width;
+        m_arrangeFrom = 0; // (Moves the columns on the right, in every row.)
+        for (size_t i : m_spanning)
+        {
+            const Cell& cell = m_cells[i];
+            if (cell.col <= c && c < cell.col + cell.cols - 1)
+                m_columns[cell.col + cell.cols - 1].changed = true;
+        }
+    }
+    for (size_t r = 0; r < m_rows.size(); ++r)
+    {
+        Row& row = m_rows[r];
+        if (!row.changed) continue;
+        row.changed = false;
+
+        float height = row.base;
+        for (size_t i : m_spanning)
+        {
+            const Cell& cell = m_cells[i];
+            if (cell.rows == 1 || cell.row + cell.rows - 1 != r) continue;
+            float h = g * float(cell.rows - 1) + height;
+            for (size_t k = cell.row; k < r; ++k) h += m_rowHeights[k];
+            if (cell.size.y > h) height += cell.size.y - h;
+        }
+        if (height == m_rowHeights[r]) continue;
+
+        m_rowHeights[r] = height;
+        m_arrangeFrom = min(m_arrangeFrom, r + 1); // The rows below have moved
+        for (size_t i : m_spanning)
+        {
+            const Cell& cell = m_cells[i];
+            if (cell.row <= r && r < cell.row + cell.rows - 1)
+                m_rows[cell.row + cell.rows - 1].changed = true;
+        }
+    }
+
+    sf::Vector2f content{};
+    for (float w : m_colWidths)  content.x += w;
+    for (float h : m_rowHeights) content.y += h;
+    if (!m_columns.empty()) content.x += g * float(m_columns.size() - 1);
+    if (!m_rows.empty())    content.y += g * float(m_rows.size() - 1);
+    else content.x = 0; // (Empty grids are empty, regardless of the columns.)
+
+    m_contentSize = content;
+}
+
+
+sf::Vector2f Grid::computeSize(const Constraints& constraints)
+{
+    updateExtents();
+    return constraints.clamp(m_contentSize);
+}
+
+
+void Grid::recomputeGeometry()
+{
+    updateExtents();
+    if (!updateSize(m_contentSize))
+        arrangeChildren();
+}
+
+
+void Grid::onResized()
+{
+    m_arrangeFrom = 0; // The Fill columns may have changed
+    arrangeChildren();
+}
+
+
+void Grid::arrangeChildren()
+{
+    if (!m_placed || (m_arrangeFrom >= m_rows.size() && m_resized.empty()))
+        return;
+
+    const float g = gap();
+
+    // Column positions, with the extra width (if any) shared by the Fill columns
+    float extra = max(0.f, getSize().x - m_contentSize.x), weights = 0;
+    for (const auto& column : m_columns)
+        if (column.sizing == Sizing::Fill) weights += column.value > 0 ? column.value : 1;
+    m_colPos.resize(m_columns.size());
+    float x = 0;
+    for (size_t c = 0; c < m_columns.size(); ++c)
+    {
+        m_colPos[c] = x;
+        x += m_colWidths[c] + g;
+        if (m_columns[c].sizing == Sizing::Fill && weights > 0)
+            x += extra * (m_columns[c].value > 0 ? m_columns[c].value : 1) / weights;
+    }
+    m_rowPos.resize(m_rows.size());
+    float y = 0;
+    for (size_t r = 0; r < m_rows.size(); ++r)
+    {
+        m_rowPos[r] = y;
+        y += m_rowHeights[r] + g;
+    }
+
+    // Move only what's in (or reaches into) the moved rows...
+    auto moved = [this](const Cell& cell) { return cell.row + cell.rows > m_arrangeFrom; };
+    if (m_arrangeFrom < m_rows.size())
+    {
+        for (size_t i = m_rows[m_arrangeFrom].first; i < m_cells.size(); ++i)
+            arrangeCell(m_cells[i]);
+        for (size_t i : m_spanning)
+            if (m_cells[i].row < m_arrangeFrom && moved(m_cells[i]))
+                arrangeCell(m_cells[i]);
+    }
+    // ...and resize the rest of the changed ones where they are
+    for (size_t i : m_resized)
+        if (!moved(m_cells[i]))
+            arrangeCell(m_cells[i]);
+
+    m_resized.clear();
+    m_arrangeFrom = NONE;
+}
+
+
+void Grid::arrangeCell(const Cell& cell)
+{
+    cell.widget->arrange({{m_colPos[cell.col], m_rowPos[cell.row]}, cell.size});
+}
+
+} // namespace
@@ -1,7 +1,14 @@
 #include "sfw/Theme.hpp"
+#include "sfw/Gfx/SdfFont.hpp"
+#include "sfw/Gfx/TextLayout.hpp"
+
+#include <SFML/Graphics/Image.hpp>
 
 #include <string>
 using std::string;
+#include <vector>
+#include <algorithm>
+#include <cstdint>
 
 namespace sfw
 {
@@ -58,6 +65,7 @@ Theme::Style Theme::click;
 Theme::Style Theme::input;
 sf::Color Theme::bgColor = sf::Color::White;
 bool Theme::clearBackground = true;
+bool Theme::sdfText = false;
 int Theme::borderSize = 1; //! Will get reset based on the loaded texture, so no use setting it here!
 int Theme::minWidgetWidth = 86;
 float Theme::PADDING = 1.f;
@@ -76,23 +84,50 @@ sf::Event::KeyEvent Theme::previousWidgetKey = { .code = sf::Keyboard::Tab, .shi
 
 sf::Font Theme::m_font;
 sf::Texture Theme::m_texture;
+sf::Image Theme::m_textureImage;
 sf::IntRect Theme::m_subrects[_TEXTURE_ID_COUNT];
+sf::Vector2f Theme::m_solidTexel;
 
 sf::Cursor& Theme::cursor = getDefaultCursor();
 
 bool Theme::loadFont(const std::string& filename)
 {
-    return m_font.loadFromFile(filename);
+    gfx::SdfFont::forget(m_font); // Its glyphs would be stale
+    if (!m_font.loadFromFile(filename))
+        return false;
+    gfx::SdfFont::load(m_font, filename); // For Theme::sdfText (it has its own face of the font)
+    return true;
 }
 
 
 bool Theme::loadTexture(const std::string& filename)
 {
-    if (m_texture.loadFromFile(filename))
+    sf::Image image;
+    if (!image.loadFromFile(filename))
+    {
+        return false;
+    }
+
+    // Append a column of white pixels to the right edge of the sprite sheet,
+    // so the renderer can draw solid (untextured) shapes from the same texture,
+    // without breaking its batches:
+    sf::Vector2u size = image.getSize();
+    std::vector<std::uint8_t> pixels((size.x + 1) * size.y * 4, 255);
+    const std::uint8_t* src = image.getPixelsPtr();
+    for (unsigned y = 0; y < size.y; ++y)
+    {
+        std::copy(src + y * size.x * 4, src + (y + 1) * size.x * 4, pixels.begin() + y * (size.x + 1) * 4);
+    }
+    sf::Image extended;
+    extended.create({size.x + 1, size.y}, pixels.data());
+
+    // (The headless backend would never sample it, so it can go without
+    // uploading it, i.e. without needing a GL context for that.)
+    if (gfx::Renderer::headless || m_texture.loadFromImage(extended))
     {
         sf::IntRect subrect;
-        subrect.width = m_texture.getSize().x;
-        subrect.height = m_texture.getSize().y / _TEXTURE_ID_COUNT;
+        subrect.width = size.x; // Not the texture width, which has the extra column!
+        subrect.height = size.y / _TEXTURE_ID_COUNT;
 
         for (int i = 0; i < _TEXTURE_ID_COUNT; ++i)
         {
@@ -101,6 +136,8 @@ bool Theme::loadTexture(const std::string& filename)
         }
 
         borderSize = subrect.width / 3;
+        m_solidTexel = {(float)size.x + 0.5f, 0.5f};
+        m_textureImage = extended;
         return true;
     }
     return false;
@@ -119,6 +156,12 @@ const sf::Texture& Theme::getTexture()
 }
 
 
+const sf::Image& Theme::getTextureImage()
+{
+    return m_textureImage;
+}
+
+
 const sf::IntRect& Theme::getTextureRect(Box::Type type, WidgetState state)
 {
     TextureID id(BOX_DEFAULT);
@@ -159,6 +202,12 @@ const sf::IntRect& Theme::getProgressBarTextureRect()
 }
 
 
+const sf::Vector2f& Theme::getSolidTexel()
+{
+    return m_solidTexel;
+}
+
+
 float Theme::getBoxHeight()
 {
     return getLineSpacing() + borderSize * 2 + PADDING * 2;
@@ -167,7 +216,7 @@ float Theme::getBoxHeight()
 
 int Theme::getLineSpacing()
 {
-    return (int)m_font.getLineSpacing((unsigned)textSize);
+    return (int)gfx::lineSpacing(m_font, (unsigned)textSize);
 }
 
 } // namespace
@@ -1,10 +1,12 @@
 #include "sfw/Widget.hpp"
 #include "sfw/WidgetContainer.hpp"
+#include "sfw/Layout.hpp"
 #include "sfw/GUI-main.hpp"
 #include "sfw/util/diagnostics.hpp"
 
 #include <cassert>
 #include <cmath>
+#include <mutex>
 
 #ifdef DEBUG
 #
@@ -85,12 +87,15 @@ Widget* Widget::getWidget(const std::string& name) const
 
 void Widget::setPosition(const sf::Vector2f& pos)
 {
+    invalidate(); // the area being left
     m_position = {roundf(pos.x), roundf(pos.y)};
+    invalidateParentHitIndex();
     m_transform = sf::Transform(
         1, 0, m_position.x, // translate x
         0, 1, m_position.y, // translate y
         0, 0, 1
     );
+    invalidate();
 }
 
 void Widget::setPosition(float x, float y)
@@ -105,6 +110,14 @@ const sf::Vector2f& Widget::getPosition() const
 }
 
 
+void Widget::invalidateParentHitIndex() const
+{
+    if (!isRoot())
+        if (Layout* layout = getParent()->toLayout(); layout)
+            layout->invalidateHitIndex();
+}
+
+
 sf::Vector2f Widget::getAbsolutePosition() const
 {
     sf::Vector2f position = m_position;
@@ -122,10 +135,34 @@ sf::Vector2f Widget::getAbsolutePosition() const
 
 void Widget::setSize(const sf::Vector2f& size)
 {
-    m_size = sf::Vector2f(roundf(size.x), roundf(size.y));
+    sf::Vector2f new_size(roundf(size.x), roundf(size.y));
+    if (new_size == m_preferredSize) return; // Nothing to relayout (this stops the cascades early, too)
 
-    onResized();
-    if (!isRoot()) getParent()->recomputeGeometry();
+    if (new_size != m_size)
+    {
+        invalidate(); // the old area (in case of shrinking)
+        m_size = new_size;
+        invalidate();
+        invalidateParentHitIndex();
+        onResized();
+    }
+    setPreferredSize(new_size);
+}
+
+
+bool Widget::setPreferredSize(const sf::Vector2f& size)
+{
+    sf::Vector2f new_size(roundf(size.x), roundf(size.y));
+    if (new_size == m_preferredSize) return false;
+    m_preferredSize = new_size;
+    m_measureValid = false;
+
+    if (!isRoot())
+    {
+        getParent()->onChildResized(this);
+        getParent()->requestLayout(); // (Applied by the next updateLayout().)
+    }
+    return true;
 }
 
 
@@ -135,6 +172,40 @@ void Widget::setSize(float width, float height)
 }
 
 
+sf::Vector2f Widget::measure(const Constraints& constraints)
+{
+    if (!m_measureValid || !(m_measuredFor == constraints))
+    {
+        m_measured = computeSize(constraints);
+        m_measuredFor = constraints;
+        m_measureValid = true;
+    }
+    return m_measured;
+}
+
+
+sf::Vector2f Widget::computeSize(const Constraints& constraints)
+{
+    return constraints.clamp(m_preferredSize);
+}
+
+
+void Widget::arrange(const sf::FloatRect& rect)
+{
+    if (sf::Vector2f pos(roundf(rect.left), roundf(rect.top)); pos != m_position)
+        setPosition(pos);
+
+    sf::Vector2f new_size(roundf(rect.width), roundf(rect.height));
+    if (new_size == m_size) return;
+
+    invalidate();
+    m_size = new_size;
+    invalidate();
+    invalidateParentHitIndex();
+    onResized(); // (Containers can lay out their children for the new size here.)
+}
+
+
 const sf::Vector2f& Widget::getSize() const
 {
     return m_size;
@@ -147,6 +218,49 @@ bool Widget::containsPoint(const sf::Vector2f& point) const
 }
 
 
+void Widget::invalidate() const
+{
+    // The widget's own state is only touched by the thread drawing it, so
+    // the callback needs no locking (and can do anything, incl. invalidating
+    // other widgets)
+    onInvalidated();
+
+    // But widgets may also invalidate themselves while being drawn, possibly
+    // on several threads at once (see GUI::setParallelBuild()), and these
+    // reach up to the shared ancestors
+    Widget* root = getRoot();
+    std::unique_lock<std::mutex> lock;
+    if (root->isMain()) lock = std::unique_lock(((GUI*)root)->m_damageMutex);
+
+    // The offscreen caches of the enclosing layouts (if any) are now stale
+    for (const Widget* w = this; !w->isRoot();)
+    {
+        w = w->getParent();
+        if (Layout* layout = const_cast<Widget*>(w)->toLayout(); layout)
+            layout->invalidateCache();
+    }
+
+    if (isMain())
+    {
+        ((GUI*)this)->damage(); // Also repaint the window bg. around the GUI
+    }
+    else if (root->isMain())
+    {
+        ((GUI*)root)->damage({getAbsolutePosition(), getSize()});
+    }
+}
+
+
+void Widget::invalidate(sf::Time delay) const
+{
+    if (Widget* root = getRoot(); root->isMain())
+    {
+        std::lock_guard lock(((GUI*)root)->m_damageMutex); // (See above.)
+        ((GUI*)root)->scheduleRepaint(this, delay);
+    }
+}
+
+
 bool Widget::isSelectable() const
 {
     return m_selectable;
@@ -196,6 +310,7 @@ void Widget::setState(WidgetState state)
 {
     m_state = state;
     onStateChanged(state);
+    invalidate();
 }
 
 
@@ -225,6 +340,7 @@ void Widget::onKeyReleased(const sf::Event::KeyEvent&) { }
 void Widget::onTextEntered(uint32_t) { }
 void Widget::onThemeChanged() { }
 void Widget::onResized() { }
+void Widget::onInvalidated() const { }
 
 
 // diagnostics ---------------------------------------------------------------
@@ -237,7 +353,7 @@ void Widget::draw_outline([[maybe_unused]] const gfx::RenderContext& ctx, sf::Co
 	r.setFillColor(sf::Color::Transparent);
 	r.setOutlineThickness(2);
 	r.setOutlineColor(color);
-	ctx.target.draw(r);
+	ctx.renderer.draw(r);
 }
 #endif
 
@@ -1,6 +1,7 @@
 #include "sfw/WidgetContainer.hpp"
 
 #include "sfw/GUI-main.hpp"
+#include "sfw/Layout.hpp"
 #include "sfw/util/shims.hpp"
 
 #include <cassert>
@@ -105,13 +106,77 @@ Widget* WidgetContainer::insertAfter(Widget* anchor, Widget* widget, const std::
         Main->remember(widget, name); // Will assign default if name.empty()!
     }
 
-    // Adjust the layout
-    recomputeGeometry();
+    // Adjust the layout (later, see updateLayout())
+    // (A container may be added with its own layout still pending, too.)
+    if (Layout* layout = widget->toLayout(); layout && layout->layoutPending())
+        m_childLayoutDirty = true;
+    onChildAdded(widget);
+    requestLayout();
+    if (Layout* layout = toLayout(); layout) layout->invalidateHitIndex();
+
+    // Might not have been moved at all by the above, but it's new there anyway
+    widget->invalidate();
 
     return widget;
 }
 
 
+void WidgetContainer::requestLayout()
+{
+    m_layoutDirty = true;
+    m_measureValid = false;
+
+    // Mark the path to the root, too, as far as it's not already marked
+    for (Widget* w = this; !w->isRoot();)
+    {
+        WidgetContainer* parent = w->getParent();
+        if (parent->m_childLayoutDirty && !parent->m_measureValid) break;
+        parent->m_childLayoutDirty = true;
+        parent->m_measureValid = false;
+        w = parent;
+    }
+}
+
+
+void WidgetContainer::updateLayout()
+{
+    // Repeated while anything is pending here, because recomputing the
+    // geometry here arranges the children, which may then need their own
+    // layout updated again (and that may even resize them, dirtying this
+    // one, too). Bounded, in case some widgets keep resizing each other.
+    constexpr int MAX_ROUNDS = 8;
+    for (int round = 0; layoutPending(); ++round)
+    {
+        if (round == MAX_ROUNDS)
+        {
+#ifdef DEBUG
+            std::cerr << "- Warning: The layout of \"" << getName() << "\" doesn't settle, left for the next update!\n";
+#endif
+            break;
+        }
+
+        // Children first, as their size may change the layout here
+        if (m_childLayoutDirty)
+        {
+            for (Widget* w = m_first; w != nullptr; w = w->m_next)
+            {
+                if (Layout* layout = w->toLayout(); layout && layout->layoutPending())
+                    layout->updateLayout();
+            }
+            // Only cleared now, so that requests from the children (resized
+            // above) stop here, and won't mark the (already visited) path above
+            m_childLayoutDirty = false;
+        }
+
+        if (m_layoutDirty)
+        {
+            m_layoutDirty = false;
+            recomputeGeometry(); // (If this resizes us, our parent gets marked, and recomputed after this.)
+        }
+    }
+}
+
+
 Widget* WidgetContainer::add(Widget* widget, const std::string& name)
 {
     return insertAfter(m_last, widget, name);
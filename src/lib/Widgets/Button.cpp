@@ -1,5 +1,6 @@
 #include "sfw/Widgets/Button.hpp"
 #include "sfw/Theme.hpp"
+#include "sfw/Gfx/TextLayout.hpp"
 #include "sfw/util/shims.hpp"
 
 #include <algorithm>
@@ -43,20 +44,24 @@ void Button::onThemeChanged()
 {
     m_box.item().setFont(Theme::getFont());
     m_box.item().setCharacterSize((int)Theme::textSize);
-    m_box.setSize((float)Theme::minWidgetWidth, Theme::getBoxHeight());
     recomputeGeometry();
 }
 
 
 void Button::recomputeGeometry()
 {
-    int fittingWidth = (int)(m_box.item().getLocalBounds().width + Theme::PADDING * 2 + Theme::borderSize * 2);
+    int fittingWidth = (int)(gfx::textBounds(m_box.item()).width + Theme::PADDING * 2 + Theme::borderSize * 2);
     int width = max(fittingWidth, Theme::minWidgetWidth);
 
-    m_box.setSize((float)width, Theme::getBoxHeight());
-    m_box.centerTextHorizontally(m_box.item());
+    setSize((float)width, Theme::getBoxHeight());
+    onResized(); // (setSize() doesn't call it, if the size hasn't changed, but the text may have.)
+}
+
 
-    setSize(m_box.getSize());
+void Button::onResized()
+{
+    m_box.setSize(getSize().x, getSize().y);
+    m_box.centerTextHorizontally(m_box.item());
 }
 
 
@@ -64,7 +69,7 @@ void Button::draw(const gfx::RenderContext& ctx) const
 {
     auto sfml_renderstates = ctx.props;
     sfml_renderstates.transform *= getTransform();
-    ctx.target.draw(m_box, sfml_renderstates);
+    ctx.renderer.draw(m_box, sfml_renderstates);
 }
 
 // Callbacks -------------------------------------------------------------------
@@ -83,6 +88,7 @@ void Button::onMouseMoved(float x, float y)
             m_box.press();
         else
             m_box.release();
+        invalidate();
     }
 }
 
@@ -90,6 +96,7 @@ void Button::onMouseMoved(float x, float y)
 void Button::onMousePressed([[maybe_unused]] float x, [[maybe_unused]] float y)
 {
     m_box.press();
+    invalidate();
 }
 
 
@@ -108,6 +115,7 @@ void Button::onKeyPressed(const sf::Event::KeyEvent& key)
     {
         triggerCallback();
         m_box.press();
+        invalidate();
     }
 }
 
@@ -117,6 +125,7 @@ void Button::onKeyReleased(const sf::Event::KeyEvent& key)
     if (key.code == sf::Keyboard::Enter)
     {
         m_box.release();
+        invalidate();
     }
 }
 
@@ -0,0 +1,107 @@
+#include "sfw/Widgets/Canvas.hpp"
+
+#include <SFML/Graphics/RenderTarget.hpp>
+
+#include <algorithm>
+    using std::min, std::max;
+#include <iostream>
+    using std::cerr;
+
+namespace sfw
+{
+
+Canvas::Canvas(const sf::Vector2f& size):
+    m_buffer(sf::PrimitiveType::Triangles, sf::VertexBuffer::Usage::Static)
+{
+    setSelectable(false);
+    if (size.x > 0 && size.y > 0)
+        setSize(size);
+}
+
+
+Canvas* Canvas::setGeometry(const sf::Vertex* vertices, size_t count, sf::PrimitiveType type,
+                            const sf::Texture* texture)
+{
+    m_vertices.assign(vertices, vertices + count);
+    m_type = type;
+    m_texture = texture;
+    m_recreate = true;
+    invalidate();
+    return this;
+}
+
+
+Canvas* Canvas::updateGeometry(size_t offset, const sf::Vertex* vertices, size_t count)
+{
+    if (offset >= m_vertices.size() || !count)
+        return this;
+    count = min(count, m_vertices.size() - offset);
+
+    std::copy(vertices, vertices + count, m_vertices.begin() + (std::ptrdiff_t)offset);
+    if (m_dirtyFrom == m_dirtyTo)
+    {
+        m_dirtyFrom = offset;
+        m_dirtyTo = offset + count;
+    }
+    else // (Just one range is tracked: a few small updates far apart still upload everything between them.)
+    {
+        m_dirtyFrom = min(m_dirtyFrom, offset);
+        m_dirtyTo = max(m_dirtyTo, offset + count);
+    }
+    invalidate();
+    return this;
+}
+
+
+bool Canvas::upload() const
+{
+    if (m_gpuFailed)
+        return false;
+
+    if (m_recreate)
+    {
+        m_buffer.setPrimitiveType(m_type);
+        if (!m_buffer.create(m_vertices.size()) || !m_buffer.update(m_vertices.data()))
+        {
+            cerr << "- ERROR: Failed to upload the geometry of a Canvas (" << m_vertices.size()
+                 << " vertices), drawing it from system memory instead.\n";
+            m_gpuFailed = true;
+            return false;
+        }
+        m_recreate = false;
+        m_dirtyFrom = m_dirtyTo = 0;
+    }
+    else if (m_dirtyFrom < m_dirtyTo)
+    {
+        if (!m_buffer.update(m_vertices.data() + m_dirtyFrom, m_dirtyTo - m_dirtyFrom, (unsigned)m_dirtyFrom))
+        {
+            cerr << "- ERROR: Failed to update the geometry of a Canvas, drawing it from system memory instead.\n";
+            m_gpuFailed = true;
+            return false;
+        }
+        m_dirtyFrom = m_dirtyTo = 0;
+    }
+    return true;
+}
+
+
+void Canvas::draw(const gfx::RenderContext& ctx) const
+{
+    if (m_vertices.empty())
+        return;
+
+    auto sfml_renderstates = ctx.props;
+    sfml_renderstates.transform *= getTransform();
+    sfml_renderstates.texture = m_texture;
+
+    ctx.pushClip({{0, 0}, getSize()}, sfml_renderstates);
+    // The buffer can only be drawn if the drawing goes right to the target
+    // (i.e. on its thread, with its GL context active)
+    if (ctx.renderer.submitting() && sf::VertexBuffer::isAvailable() && upload())
+        ctx.renderer.draw(m_buffer, sfml_renderstates);
+    else
+        ctx.renderer.draw(m_vertices.data(), m_vertices.size(), m_type, sfml_renderstates);
+    ctx.popClip();
+}
+
+} // namespace
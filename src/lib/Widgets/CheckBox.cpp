@@ -28,6 +28,7 @@ CheckBox::CheckBox(std::function<void(CheckBox*)> callback, bool checked):
 CheckBox* CheckBox::set(bool checked)
 {
     m_checked = checked;
+    invalidate();
     triggerCallback();
     return this;
 }
@@ -37,9 +38,9 @@ void CheckBox::draw(const gfx::RenderContext& ctx) const
 {
     auto sfml_renderstates = ctx.props;
     sfml_renderstates.transform *= getTransform();
-    ctx.target.draw(m_box, sfml_renderstates);
+    ctx.renderer.draw(m_box, sfml_renderstates);
     if (checked())
-        ctx.target.draw(m_checkmark, sfml_renderstates);
+        ctx.renderer.draw(m_checkmark, sfml_renderstates);
 }
 
 
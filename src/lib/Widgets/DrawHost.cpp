@@ -1,5 +1,6 @@
 #include "sfw/Widgets/DrawHost.hpp"
 #include "sfw/Theme.hpp"
+#include "sfw/Gfx/Render.hpp"
 
 #include <SFML/Graphics/RenderTarget.hpp>
 
@@ -15,13 +16,63 @@ DrawHost::DrawHost(const DrawHook& hook)
 Widget* DrawHost::setDrawHook(const DrawHook& hook)
 {
     m_drawHook = hook;
+    invalidate();
     return this;
 }
 
 
+DrawHost* DrawHost::setCaching(bool enable)
+{
+    m_caching = enable;
+    if (!enable) m_cache.release(); // Give the memory back
+    invalidate();
+    return this;
+}
+
+
+bool DrawHost::isCacheValid() const
+{
+    return m_cache.valid();
+}
+
+
+void DrawHost::onResized()
+{
+    m_cache.invalidate();
+}
+
+
+void DrawHost::onInvalidated() const
+{
+    m_cache.invalidate();
+}
+
+
+bool DrawHost::drawCached(const gfx::RenderContext& ctx) const
+{
+    auto sfml_renderstates = ctx.props;
+
+    // The hook gets the same transform as usual (see draw()), the cache
+    // just needs to know where the widget is
+    sf::RenderStates area = ctx.props;
+    area.transform *= getTransform();
+    return m_cache.draw(ctx, area, getSize(), [&](const gfx::RenderContext& cctx) {
+        m_drawHook(const_cast<DrawHost*>(this), gfx::RenderContext{cctx.target, sfml_renderstates, cctx.renderer});
+    });
+}
+
+
 void DrawHost::draw(const gfx::RenderContext& ctx) const
 {
+    // (No point in caching if the drawing doesn't even go to the target.)
+    if (m_caching && ctx.renderer.submitting() && drawCached(ctx))
+        return;
+
+    ctx.renderer.flush(); // The hook may draw directly to the target
     m_drawHook(const_cast<DrawHost*>(this), ctx);
+
+    // We can't know what the hook draws, so assume it's animating...
+    invalidate();
 }
 
 } // namespace
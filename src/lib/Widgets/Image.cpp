@@ -78,6 +78,7 @@ Image* Image::setCropRect(const sf::IntRect& r)
     m_vertices[1].texCoords = sf::Vector2f(left, top + height);
     m_vertices[2].texCoords = sf::Vector2f(left + width, top);
     m_vertices[3].texCoords = sf::Vector2f(left + width, top + height);
+    invalidate(); // setSize() below won't, if the size remains the same
 
     setSize(m_baseSize * m_scalingFactor);
     return this;
@@ -110,6 +111,7 @@ Image* Image::setColor(const sf::Color& color)
 {
     for (int i = 0; i < 4; ++i)
         m_vertices[i].color = color;
+    invalidate();
     return this;
 }
 
@@ -129,7 +131,7 @@ void Image::draw(const gfx::RenderContext& ctx) const
     auto sfml_renderstates = ctx.props;
     sfml_renderstates.transform *= getTransform();
     sfml_renderstates.texture = &m_texture;
-    ctx.target.draw(m_vertices, 4, sf::PrimitiveType::TriangleStrip, sfml_renderstates);
+    ctx.renderer.draw(m_vertices, 4, sf::PrimitiveType::TriangleStrip, sfml_renderstates);
 #ifdef DEBUG
 //    Widget::draw_outline(ctx);
 #endif
@@ -1,5 +1,6 @@
 #include "sfw/Widgets/ImageButton.hpp"
 #include "sfw/Theme.hpp"
+#include "sfw/Gfx/TextLayout.hpp"
 
 #include <SFML/Graphics/RenderTarget.hpp>
 #include <SFML/Graphics/Text.hpp>
@@ -32,6 +33,8 @@ ImageButton* ImageButton::setTexture(const sf::Texture& texture)
     m_background.setTextureRect(sf::IntRect({0, 0}, {width, height}));
 
     Widget::setSize((float)width, (float)height);
+    onResized(); // (Not called by setSize() if the size is the same, but the texture may be different.)
+    centerText();
     return this;
 }
 
@@ -40,6 +43,7 @@ ImageButton* ImageButton::setText(const sf::String& text)
 {
     m_text.setString(text);
     centerText();
+    invalidate();
     return this;
 }
 
@@ -52,9 +56,7 @@ const sf::String& ImageButton::getText() const
 
 ImageButton* ImageButton::setSize(sf::Vector2f size)
 {
-    m_background.setScale({size.x / m_background.getTexture()->getSize().x,
-                           size.y / m_background.getTexture()->getSize().y * 3}); // see the ctor for that 3! ;)
-    Widget::setSize(size);
+    Widget::setSize(size); // (The image is scaled to it in onResized().)
     return this;
 }
 
@@ -62,6 +64,7 @@ ImageButton* ImageButton::setFont(const sf::Font& font)
 {
     m_text.setFont(font);
     centerText();
+    invalidate();
     return this;
 }
 
@@ -76,6 +79,7 @@ ImageButton* ImageButton::setTextSize(size_t size)
 {
     m_text.setCharacterSize((unsigned)size);
     centerText();
+    invalidate();
     return this;
 }
 
@@ -83,6 +87,7 @@ ImageButton* ImageButton::setTextSize(size_t size)
 ImageButton* ImageButton::setTextStyle(sf::Text::Style style)
 {
     m_text.setStyle(style);
+    invalidate();
     return this;
 }
 
@@ -90,6 +95,7 @@ ImageButton* ImageButton::setTextStyle(sf::Text::Style style)
 ImageButton* ImageButton::setTextColor(sf::Color color)
 {
     m_text.setFillColor(color);
+    invalidate();
     return this;
 }
 
@@ -98,14 +104,22 @@ void ImageButton::draw(const gfx::RenderContext& ctx) const
 {
     auto sfml_renderstates = ctx.props;
     sfml_renderstates.transform *= getTransform();
-    ctx.target.draw(m_background, sfml_renderstates);
+    ctx.renderer.draw(m_background, sfml_renderstates);
     sfml_renderstates.transform *= m_background.getTransform(); // Follow the scaling (etc.) of the image!
-    ctx.target.draw(m_text, sfml_renderstates);
+    ctx.renderer.draw(m_text, sfml_renderstates);
 }
 
 
 // Callbacks -------------------------------------------------------------------
 
+void ImageButton::onResized()
+{
+    // Stretch the image (and the text with it, see draw()) to the actual size
+    sf::FloatRect image = m_background.getLocalBounds(); // (A single state, see the ctor.)
+    m_background.setScale({getSize().x / image.width, getSize().y / image.height});
+}
+
+
 void ImageButton::onStateChanged(WidgetState state)
 {
     sf::Vector2i size(m_background.getTexture()->getSize().x,
@@ -178,6 +192,7 @@ void ImageButton::press()
     {
         m_pressed = true;
         m_text.move({0, 1});
+        invalidate();
     }
 }
 
@@ -188,14 +203,17 @@ void ImageButton::release()
     {
         m_pressed = false;
         m_text.move({0, -1});
+        invalidate();
     }
 }
 
 
 void ImageButton::centerText()
 {
-    auto [boxwidth, boxheight] = getSize();
-    sf::FloatRect t = m_text.getLocalBounds();
+    // (In the coordinates of the unscaled image, as the text is drawn scaled with it.)
+    sf::FloatRect image = m_background.getLocalBounds();
+    float boxwidth = image.width, boxheight = image.height;
+    sf::FloatRect t = gfx::textBounds(m_text);
     m_text.setOrigin({t.left + round(t.width / 2.f), t.top + round(t.height / 2.f)});
     m_text.setPosition({boxwidth / 2, boxheight / 2});
 }
@@ -1,5 +1,6 @@
 #include "sfw/Widgets/Label.hpp"
 #include "sfw/Theme.hpp"
+#include "sfw/Gfx/TextLayout.hpp"
 #include "sfw/util/shims.hpp"
 
 #include <SFML/Graphics/RenderTarget.hpp>
@@ -31,6 +32,7 @@ std::string Label::getText() const
 Label* Label::setFillColor(const sf::Color& color)
 {
     m_text.setFillColor(color);
+    invalidate();
     return this;
 }
 
@@ -56,6 +58,7 @@ size_t Label::getTextSize() const
 Label* Label::setStyle(sf::Text::Style style)
 {
     m_text.setStyle(style);
+    invalidate();
     return this;
 }
 
@@ -64,7 +67,7 @@ void Label::draw(const gfx::RenderContext& ctx) const
 {
     auto sfml_renderstates = ctx.props;
     sfml_renderstates.transform *= getTransform();
-    ctx.target.draw(m_text, sfml_renderstates);
+    ctx.renderer.draw(m_text, sfml_renderstates);
 }
 
 
@@ -80,9 +83,10 @@ void Label::onThemeChanged()
 
 void Label::recomputeGeometry()
 {
+    sf::FloatRect bounds = gfx::textBounds(m_text);
     Widget::setSize(
-        m_text.getLocalBounds().width + Theme::PADDING * 2  + m_text.getLocalBounds().left,
-        m_text.getLocalBounds().height + Theme::PADDING * 2 + m_text.getLocalBounds().top
+        bounds.width + Theme::PADDING * 2  + bounds.left,
+        bounds.height + Theme::PADDING * 2 + bounds.top
     );
 }
 
@@ -1,5 +1,6 @@
 #include "sfw/Widgets/ProgressBar.hpp"
 #include "sfw/Theme.hpp"
+#include "sfw/Gfx/TextLayout.hpp"
 
 #include <SFML/Graphics/RenderTarget.hpp>
 
@@ -12,58 +13,30 @@ ProgressBar::ProgressBar(float length, Orientation orientation, LabelPlacement l
     m_labelPlacement(labelPlacement),
     m_value(0.f)
 {
-    if (orientation == Horizontal)
-    {
-        m_box.setSize(length, Theme::getBoxHeight());
-    }
-    else
-    {
-        m_box.setSize(Theme::getBoxHeight(), length);
-        if (m_labelPlacement == LabelOver)
-            m_label.setRotation(sf::degrees(90.f));
-    }
+    if (orientation == Vertical && m_labelPlacement == LabelOver)
+        m_label.setRotation(sf::degrees(90.f));
 
     m_label.setString("100%");
     m_label.setFont(Theme::getFont());
     m_label.setFillColor(Theme::input.textColor);
     m_label.setCharacterSize((unsigned)Theme::textSize);
 
-    // Build bar
-    const float x1 = Theme::PADDING;
-    const float y1 = Theme::PADDING;
-    const float x2 = (orientation == Horizontal ? length : Theme::getBoxHeight()) - Theme::PADDING;
-    const float y2 = (orientation == Horizontal ? Theme::getBoxHeight() : length) - Theme::PADDING;
-    m_bar[0].position = {x1, y1};
-    m_bar[1].position = {x1, y2};
-    m_bar[2].position = {x2, y1};
-    m_bar[3].position = {x2, y2};
-
     sf::FloatRect rect = (sf::FloatRect)Theme::getProgressBarTextureRect();
     m_bar[0].texCoords = sf::Vector2f(rect.left, rect.top);
     m_bar[1].texCoords = sf::Vector2f(rect.left, rect.top + rect.height);
     m_bar[2].texCoords = sf::Vector2f(rect.left + rect.width, rect.top);
     m_bar[3].texCoords = sf::Vector2f(rect.left + rect.width, rect.top + rect.height);
 
-    float labelWidth = m_label.getLocalBounds().width;
-    float labelHeight = m_label.getLocalBounds().height;
+    // Room for the label outside the bar (on the right, or below it)
+    sf::FloatRect labelBounds = gfx::textBounds(m_label);
     if (m_labelPlacement == LabelOutside)
-    {
-        if (orientation == Horizontal)
-        {
-            // Place label on the right of the bar
-            m_label.setPosition({length + Theme::PADDING, Theme::PADDING});
-            setSize({length + Theme::PADDING + labelWidth, m_box.getSize().y});
-        }
-        else
-        {
-            // Place label below the bar
-            setSize({m_box.getSize().x, length + Theme::PADDING + labelHeight});
-        }
-    }
+        m_labelSpace = Theme::PADDING + (orientation == Horizontal ? labelBounds.width : labelBounds.height);
+
+    // (The bar is built for the actual size in onResized().)
+    if (orientation == Horizontal)
+        setSize({length + m_labelSpace, Theme::getBoxHeight()});
     else
-    {
-        setSize(m_box.getSize());
-    }
+        setSize({Theme::getBoxHeight(), length + m_labelSpace});
 
     setValue(m_value);
     setSelectable(false);
@@ -94,12 +67,40 @@ void ProgressBar::setValue(float value)
         else if (m_labelPlacement == LabelOutside)
         {
             // Re-center label horizontally (text width can change)
-            float labelX = (m_box.getSize().x - m_label.getLocalBounds().width) / 2;
+            float labelX = (m_box.getSize().x - gfx::textBounds(m_label).width) / 2;
             m_label.setPosition({labelX, m_box.getSize().y + Theme::PADDING});
         }
     }
 
     m_value = value;
+    invalidate();
+}
+
+
+void ProgressBar::onResized()
+{
+    // The box gets what the label (if outside) leaves from the arranged size
+    sf::Vector2f boxSize = getSize();
+    (m_orientation == Horizontal ? boxSize.x : boxSize.y) -= m_labelSpace;
+    m_box.setSize(boxSize.x, boxSize.y);
+
+    // Build bar
+    const float x1 = Theme::PADDING;
+    const float y1 = Theme::PADDING;
+    const float x2 = m_box.getSize().x - Theme::PADDING;
+    const float y2 = m_box.getSize().y - Theme::PADDING;
+    m_bar[0].position = {x1, y1};
+    m_bar[1].position = {x1, y2};
+    m_bar[2].position = {x2, y1};
+    m_bar[3].position = {x2, y2};
+
+    if (m_labelPlacement == LabelOutside && m_orientation == Horizontal)
+    {
+        // Place label on the right of the bar
+        m_label.setPosition({m_box.getSize().x + Theme::PADDING, Theme::PADDING});
+    }
+
+    setValue(m_value); // (Sets the progress, and places the other labels.)
 }
 
 
@@ -113,11 +114,11 @@ void ProgressBar::draw(const gfx::RenderContext& ctx) const
 {
     auto sfml_renderstates = ctx.props;
     sfml_renderstates.transform *= getTransform();
-    ctx.target.draw(m_box, sfml_renderstates);
+    ctx.renderer.draw(m_box, sfml_renderstates);
     sfml_renderstates.texture = &Theme::getTexture();
-    ctx.target.draw(m_bar, 4, sf::PrimitiveType::TriangleStrip, sfml_renderstates);
+    ctx.renderer.draw(m_bar, 4, sf::PrimitiveType::TriangleStrip, sfml_renderstates);
     if (m_labelPlacement != LabelNone)
-        ctx.target.draw(m_label, sfml_renderstates);
+        ctx.renderer.draw(m_label, sfml_renderstates);
 }
 
 } // namespace
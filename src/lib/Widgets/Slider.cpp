@@ -18,44 +18,21 @@ Slider::Slider(float step, float length, Orientation orientation):
     // fine, too, but unsigned (where applicable) is cleaner conceptually.)
     unsigned short handleHeight = (unsigned short)Theme::getBoxHeight();
     unsigned short handleWidth = handleHeight / 2;
-    unsigned short grooveHeight = (unsigned short)Theme::borderSize * 3;
-    short grooveOffset = (short)(handleHeight - grooveHeight) / 2;
 
+    for (int i = 0; i < 4; ++i)
+        m_progression[i].color = Theme::bgColor;
+
+    // The groove etc. are laid out for the actual size in onResized()
     if (orientation == Horizontal)
     {
-        m_groove.setSize(length, grooveHeight);
-        m_groove.setPosition(0, grooveOffset);
         m_handle.setSize(handleWidth, handleHeight);
-
         setSize(length, handleHeight);
-
-        for (int i = 0; i < 4; ++i)
-        {
-            m_progression[i].color = Theme::bgColor;
-            m_progression[i].position.x = m_groove.getPosition().x + Theme::borderSize;
-            m_progression[i].position.y = m_groove.getPosition().y + Theme::borderSize;
-        }
-        m_progression[1].position.y += m_groove.getSize().y - Theme::borderSize * 2;
-        m_progression[3].position.y += m_groove.getSize().y - Theme::borderSize * 2;
     }
     else
     {
-        m_groove.setSize(grooveHeight, length);
-        m_groove.setPosition(grooveOffset, 0);
         m_handle.setSize(handleHeight, handleWidth);
-
         setSize(handleHeight, length);
-
-        for (int i = 0; i < 4; ++i)
-        {
-            m_progression[i].color = Theme::bgColor;
-            m_progression[i].position.x = m_groove.getPosition().x + Theme::borderSize;
-            m_progression[i].position.y = m_groove.getSize().y - Theme::borderSize;
-        }
-        m_progression[2].position.x += m_groove.getSize().x - Theme::borderSize * 2;
-        m_progression[3].position.x += m_groove.getSize().x - Theme::borderSize * 2;
     }
-    updateHandlePosition();
 }
 
 
@@ -111,7 +88,7 @@ void Slider::updateHandlePosition()
     {
         float max = getSize().x - m_handle.getSize().x - Theme::borderSize * 2;
         float x = floor(max * m_value / 100 + Theme::borderSize);
-        m_handle.setPosition(x, 0);
+        m_handle.setPosition(x, floor((getSize().y - m_handle.getSize().y) / 2));
         m_progression[2].position.x = x;
         m_progression[3].position.x = x;
     }
@@ -120,10 +97,46 @@ void Slider::updateHandlePosition()
         float max = getSize().y - m_handle.getSize().y - Theme::borderSize * 2;
         float reverse_value = 100.f - m_value;
         float y = floor(max * reverse_value / 100 + (float)Theme::borderSize);
-        m_handle.setPosition(0, y);
+        m_handle.setPosition(floor((getSize().x - m_handle.getSize().x) / 2), y);
         m_progression[0].position.y = y;
         m_progression[2].position.y = y;
     }
+    invalidate();
+}
+
+
+void Slider::onResized()
+{
+    // The groove spans the whole length, centered across it
+    float grooveHeight = Theme::borderSize * 3;
+
+    if (m_orientation == Horizontal)
+    {
+        m_groove.setSize(getSize().x, grooveHeight);
+        m_groove.setPosition(0, floor((getSize().y - grooveHeight) / 2));
+
+        for (int i = 0; i < 4; ++i)
+        {
+            m_progression[i].position.x = m_groove.getPosition().x + Theme::borderSize;
+            m_progression[i].position.y = m_groove.getPosition().y + Theme::borderSize;
+        }
+        m_progression[1].position.y += m_groove.getSize().y - Theme::borderSize * 2;
+        m_progression[3].position.y += m_groove.getSize().y - Theme::borderSize * 2;
+    }
+    else
+    {
+        m_groove.setSize(grooveHeight, getSize().y);
+        m_groove.setPosition(floor((getSize().x - grooveHeight) / 2), 0);
+
+        for (int i = 0; i < 4; ++i)
+        {
+            m_progression[i].position.x = m_groove.getPosition().x + Theme::borderSize;
+            m_progression[i].position.y = m_groove.getSize().y - Theme::borderSize;
+        }
+        m_progression[2].position.x += m_groove.getSize().x - Theme::borderSize * 2;
+        m_progression[3].position.x += m_groove.getSize().x - Theme::borderSize * 2;
+    }
+    updateHandlePosition();
 }
 
 
@@ -131,9 +144,9 @@ void Slider::draw(const gfx::RenderContext& ctx) const
 {
     auto sfml_renderstates = ctx.props;
     sfml_renderstates.transform *= getTransform();
-    ctx.target.draw(m_groove, sfml_renderstates);
-    ctx.target.draw(m_progression, 4, sf::PrimitiveType::TriangleStrip, sfml_renderstates);
-    ctx.target.draw(m_handle, sfml_renderstates);
+    ctx.renderer.draw(m_groove, sfml_renderstates);
+    ctx.renderer.draw(m_progression, 4, sf::PrimitiveType::TriangleStrip, sfml_renderstates);
+    ctx.renderer.draw(m_handle, sfml_renderstates);
 #ifdef DEBUG
 //    Widget::draw_outline(ctx);
 #endif
@@ -178,6 +191,7 @@ void Slider::onMousePressed(float x, float y)
         setValue(100 - (100 * (y) / getSize().y));
 
     m_handle.press();
+    invalidate();
 }
 
 
@@ -201,12 +215,14 @@ void Slider::onMouseMoved(float x, float y)
     {
         m_handle.applyState(WidgetState::Default);
     }
+    invalidate(); //!! Only needed if the handle state has actually changed...
 }
 
 
 void Slider::onMouseReleased(float, float)
 {
     m_handle.release();
+    invalidate();
 }
 
 
@@ -2,11 +2,11 @@
 
 #include "sfw/Theme.hpp"
 #include "sfw/GUI-main.hpp"
+#include "sfw/Gfx/TextLayout.hpp"
 #include <sfw/util/diagnostics.hpp>
 
 #include <SFML/Graphics/RenderTarget.hpp>
 #include <SFML/Graphics/Text.hpp>
-#include <SFML/OpenGL.hpp>
 
 #include <cassert>
 #include <algorithm>
@@ -64,6 +64,7 @@ TextBox* TextBox::setMaxLength(size_t maxLength)
 
 void TextBox::setCursorPos(size_t index)
 {
+    invalidate(); // Also covers every text change (which always move the cursor)
 
     if (index > getTextLength()) // NOTE: a) The cursor pos. is unsigned.
                                  //       b) The pos. right after the end (at EOS) is OK.
@@ -78,40 +79,47 @@ void TextBox::setCursorPos(size_t index)
     m_cursorPos = index;
     m_selection.follow(index); // The selection itself will decide if and how exactly...
 
-    // Adjust the visuals...
+    updateView();
+}
+
+
+void TextBox::updateView()
+{
+    // Move the visual cursor to the current pos., scrolling the text to keep it in view
 
     float padding = Theme::borderSize + Theme::PADDING;
-    m_cursorRect.setPosition({m_text.findCharacterPos(index).x, padding});
+    m_cursorRect.left = gfx::findCharacterPos(m_text, m_cursorPos).x;
+    m_cursorRect.top = padding;
     m_cursorTimer.restart();
 
-    auto pixel_cur_pos =  m_cursorRect.getPosition().x;
+    auto pixel_cur_pos =  m_cursorRect.left;
     if (pixel_cur_pos > getSize().x - padding)
     {
         // Shift left
         float diff = pixel_cur_pos - getSize().x + padding;
         m_text.move({-diff, 0});
-        m_cursorRect.move({-diff, 0});
+        m_cursorRect.left -= diff;
     }
     else if (pixel_cur_pos < padding)
     {
         // Shift right
         float diff = padding - pixel_cur_pos;
         m_text.move({diff, 0});
-        m_cursorRect.move({diff, 0});
+        m_cursorRect.left += diff;
     }
 
-    float textWidth = m_text.getLocalBounds().width;
+    float textWidth = gfx::textBounds(m_text).width;
     if (m_text.getPosition().x < padding && m_text.getPosition().x + textWidth < getSize().x - padding)
     {
         float diff = (getSize().x - padding) - (m_text.getPosition().x + textWidth);
         m_text.move({diff, 0});
-        m_cursorRect.move({diff, 0});
+        m_cursorRect.left += diff;
         // If the text is smaller than the box, align left
         if (textWidth < (getSize().x - padding * 2))
         {
             diff = padding - m_text.getPosition().x;
             m_text.move({diff, 0});
-            m_cursorRect.move({diff, 0});
+            m_cursorRect.left += diff;
         }
     }
 }
@@ -331,7 +339,7 @@ void TextBox::onMousePressed(float x, float)
     for (pos = getTextLength(); pos > 0; --pos)
     {
         // Place the cursor after the character under the mouse
-        sf::Vector2f glyphPos = m_text.findCharacterPos(pos);
+        sf::Vector2f glyphPos = gfx::findCharacterPos(m_text, pos);
         if (glyphPos.x <= x)
         {
             break;
@@ -350,6 +358,7 @@ void TextBox::onMousePressed(float x, float)
 void TextBox::onMouseReleased(float, float)
 {
     m_selection.stop();
+    invalidate();
 }
 
 
@@ -368,7 +377,7 @@ void TextBox::onMouseMoved(float x, float)
         else for (pos = getTextLength(); pos > 0; --pos)
         {
             // Place cursor after the character under the mouse
-            sf::Vector2f glyphPos = m_text.findCharacterPos(pos);
+            sf::Vector2f glyphPos = gfx::findCharacterPos(m_text, pos);
             if (glyphPos.x <= x)
             {
                 break;
@@ -436,18 +445,24 @@ void TextBox::onThemeChanged()
     m_placeholder.setPosition({offset, offset});
 
     m_cursorColor = Theme::input.textColor;
-    m_cursorRect.setFillColor(Theme::input.textColor);
     //!! Insert/Overwrite would change it too, so this is not future-proof here at all:
-    m_cursorRect.setSize(sf::Vector2f(1.f, (float)Theme::getLineSpacing()));
-
-    m_box.setSize(m_width, Theme::getBoxHeight());
+    m_cursorRect.width = 1.f;
+    m_cursorRect.height = (float)Theme::getLineSpacing();
 
-    setSize(m_box.getSize());
+    setSize(m_width, Theme::getBoxHeight());
+    onResized(); // (setSize() doesn't call it, if the size hasn't changed, but the text metrics may have.)
 
 //!!update_view():
     //!!And then this should adjust the x offset, too (later)!
     m_text.setPosition({m_text.getPosition().x, offset});
-    m_cursorRect.setPosition({m_cursorRect.getPosition().x, offset});
+    m_cursorRect.top = offset;
+}
+
+
+void TextBox::onResized()
+{
+    m_box.setSize(getSize().x, getSize().y);
+    updateView(); // Rescroll the text for the new width
 }
 
 
@@ -456,40 +471,30 @@ void TextBox::draw(const gfx::RenderContext& ctx) const
 {
     auto sfml_renderstates = ctx.props;
     sfml_renderstates.transform *= getTransform();
-    ctx.target.draw(m_box, sfml_renderstates);
+    ctx.renderer.draw(m_box, sfml_renderstates);
 
-    // Crop the text with GL Scissor
-    glEnable(GL_SCISSOR_TEST);
-
-    sf::Vector2f pos = getAbsolutePosition();
-    auto width = max(0.f, getSize().x - 2 * Theme::borderSize - 2 * Theme::PADDING); // glScissor will fail if < 0!
-    glScissor(
-        (GLint)(pos.x + Theme::borderSize + Theme::PADDING),
-        (GLint)(ctx.target.getSize().y - (pos.y + getSize().y)),
-        (GLsizei)width,
-        (GLsizei)getSize().y
-    );
+    // Crop the text to the inner area of the box
+    float inset = Theme::borderSize + Theme::PADDING;
+    ctx.pushClip({{inset, 0}, {getSize().x - 2 * inset, getSize().y}}, sfml_renderstates);
 
     if (m_text.getString().isEmpty())
     {
-        ctx.target.draw(m_placeholder, sfml_renderstates);
+        ctx.renderer.draw(m_placeholder, sfml_renderstates);
     }
     else
     {
         // Draw the selection indicator
         if (m_selection)
         {
-            sf::RectangleShape selRect;
-            const sf::Vector2f& startPos = m_text.findCharacterPos(m_selection.lower());
-            selRect.setPosition(startPos);
-            selRect.setSize({m_text.findCharacterPos(m_selection.upper()).x - startPos.x, m_cursorRect.getSize().y});
-            selRect.setFillColor(Theme::input.textSelectionColor);
-            ctx.target.draw(selRect, sfml_renderstates);
+            auto fontLock = ctx.renderer.lockFonts(); // (findCharacterPos() uses the fonts.)
+            const sf::Vector2f& startPos = gfx::findCharacterPos(m_text, m_selection.lower());
+            ctx.renderer.fillRect({startPos, {gfx::findCharacterPos(m_text, m_selection.upper()).x - startPos.x, m_cursorRect.height}},
+                                  Theme::input.textSelectionColor, sfml_renderstates);
         }
-        ctx.target.draw(m_text, sfml_renderstates);
+        ctx.renderer.draw(m_text, sfml_renderstates);
     }
 
-    glDisable(GL_SCISSOR_TEST);
+    ctx.popClip();
 
     // Show cursor if focused
     if (isFocused())
@@ -502,8 +507,18 @@ void TextBox::draw(const gfx::RenderContext& ctx) const
 
         m_cursorColor.a = (m_cursorStyle == PULSE ? uint8_t(255 - (255 * timer / m_cursorBlinkPeriod))
                                                   : uint8_t(255 - (255 * timer / m_cursorBlinkPeriod)) & 128 ? 255 : 0);
-        m_cursorRect.setFillColor(m_cursorColor);
-        ctx.target.draw(m_cursorRect, sfml_renderstates);
+        ctx.renderer.fillRect(m_cursorRect, m_cursorColor, sfml_renderstates);
+
+        // Keep it animating: schedule the next redraw for when it will look
+        // different (so an idle GUI can sleep until then)
+        float next;
+        if (m_cursorStyle == PULSE)
+            next = m_cursorBlinkPeriod / 32; // Smooth enough
+        else if (float half = m_cursorBlinkPeriod * 127 / 255; timer < half) // Where the alpha above drops below 128
+            next = half - timer;
+        else
+            next = m_cursorBlinkPeriod - timer;
+        invalidate(sf::seconds(max(0.f, next) + 0.001f)); // +1ms to land safely in the next phase
     }
 }
 
@@ -511,11 +526,13 @@ void TextBox::draw(const gfx::RenderContext& ctx) const
 void TextBox::setSelection(size_t from, size_t length)
 {
     m_selection.set_span(from, (int)length);
+    invalidate();
 }
 
 void TextBox::clearSelection()
 {
     m_selection.cancel();
+    invalidate();
 }
 
 
@@ -542,6 +559,7 @@ void TextBox::deleteSelectedText()
 TextBox*  TextBox::setPlaceholder(const sf::String& placeholder)
 {
     m_placeholder.setString(placeholder);
+    invalidate();
 
     return this;
 }
@@ -0,0 +1,52 @@
+#include "sfw/util/alloc_guard.hpp"
+
+#include <cstdlib>
+#include <new>
+
+namespace sfw
+{
+
+namespace {
+    thread_local size_t allocations = 0;
+    thread_local unsigned paused = 0;
+}
+
+AllocationGuard::AllocationGuard():
+    m_start(allocations)
+{
+}
+
+size_t AllocationGuard::count() const
+{
+    return allocations - m_start;
+}
+
+AllocationGuard::Pause::Pause()  { ++paused; }
+AllocationGuard::Pause::~Pause() { --paused; }
+
+} // namespace
+
+
+#ifdef SFW_ALLOC_GUARD
+
+// The counting replacements of the global allocation functions
+// (The nothrow & array variants all end up calling these by default.)
+
+void* operator new(std::size_t size)
+{
+    if (!sfw::paused) ++sfw::allocations;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+#endif // SFW_ALLOC_GUARD
@@ -0,0 +1,573 @@
+#include "sfw/util/cassowary.hpp"
+
+#include <cmath>
+#include <limits>
+#include <iostream>
+    using std::cerr;
+
+namespace sfw
+{
+namespace cassowary
+{
+
+static bool near_zero(double value)
+{
+    return std::fabs(value) < 1.0e-8;
+}
+
+
+//----------------------------------------------------------------------------
+// Expressions
+//----------------------------------------------------------------------------
+Expression operator+(Expression a, const Expression& b)
+{
+    a.terms.insert(a.terms.end(), b.terms.begin(), b.terms.end());
+    a.constant += b.constant;
+    return a;
+}
+
+Expression operator*(Expression a, double k)
+{
+    for (auto& term : a.terms) term.second *= k;
+    a.constant *= k;
+    return a;
+}
+
+Expression operator*(double k, Expression a) { return std::move(a) * k; }
+Expression operator/(Expression a, double k) { return std::move(a) * (1.0 / k); }
+Expression operator-(Expression a)           { return std::move(a) * -1.0; }
+Expression operator-(Expression a, const Expression& b) { return std::move(a) + b * -1.0; }
+
+Constraint operator==(const Expression& a, const Expression& b) { return {a - b, Constraint::EQ}; }
+Constraint operator<=(const Expression& a, const Expression& b) { return {a - b, Constraint::LE}; }
+Constraint operator>=(const Expression& a, const Expression& b) { return {a - b, Constraint::GE}; }
+
+
+//----------------------------------------------------------------------------
+// Rows
+//----------------------------------------------------------------------------
+void Solver::Row::insert(const Symbol& s, double coeff)
+{
+    double& c = cells[s];
+    c += coeff;
+    if (near_zero(c)) cells.erase(s);
+}
+
+void Solver::Row::insert(const Row& other, double coeff)
+{
+    constant += other.constant * coeff;
+    for (const auto& [s, c] : other.cells)
+        insert(s, c * coeff);
+}
+
+void Solver::Row::reverseSign()
+{
+    constant = -constant;
+    for (auto& cell : cells) cell.second = -cell.second;
+}
+
+// Make this the row of `s` (which must be in it): s = ... (and remove it from the cells)
+void Solver::Row::solveFor(const Symbol& s)
+{
+    auto it = cells.find(s);
+    double coeff = -1.0 / it->second;
+    cells.erase(it);
+    constant *= coeff;
+    for (auto& cell : cells) cell.second *= coeff;
+}
+
+// lhs = row (of lhs) -> rhs = ...
+void Solver::Row::solveFor(const Symbol& lhs, const Symbol& rhs)
+{
+    insert(lhs, -1.0);
+    solveFor(rhs);
+}
+
+double Solver::Row::coeffFor(const Symbol& s) const
+{
+    auto it = cells.find(s);
+    return it != cells.end() ? it->second : 0.0;
+}
+
+void Solver::Row::substitute(const Symbol& s, const Row& row)
+{
+    if (auto it = cells.find(s); it != cells.end())
+    {
+        double coeff = it->second;
+        cells.erase(it);
+        insert(row, coeff);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Solver
+//----------------------------------------------------------------------------
+Variable Solver::newVariable()
+{
+    if (m_varSymbols.empty()) // Slot 0 is "none"
+    {
+        m_varSymbols.emplace_back();
+        m_values.push_back(0);
+    }
+    m_varSymbols.push_back(newSymbol(Symbol::External));
+    m_values.push_back(0);
+    return {m_varSymbols.size() - 1};
+}
+
+
+Solver::Symbol Solver::varSymbol(Variable v)
+{
+    return v.id < m_varSymbols.size() ? m_varSymbols[v.id] : Symbol{};
+}
+
+
+Solver::ConstraintId Solver::add(const Constraint& c, double strength)
+{
+    // Only required constraints can fail, so only those need a backup
+    //!! Just copying the tableau... Fine for layouts, as the constraints are
+    //!! normally set up once (the incremental part is suggestValue()).
+    const bool required = strength >= strength::required;
+    std::map<Symbol, Row> rows;
+    Row objective;
+    if (required) { rows = m_rows; objective = m_objective; }
+    auto restore = [&] {
+        m_rows = std::move(rows);
+        m_objective = std::move(objective);
+        m_infeasible.clear();
+        cerr << "- ERROR: Unsatisfiable required constraint!\n";
+    };
+
+    Tag tag;
+    Row row = createRow(c, strength, tag);
+    if (!tag.marker.valid())
+        return 0; // (Already reported.)
+
+    Symbol subject = chooseSubject(row, tag);
+
+    // A row of only dummies (i.e. a constant): fine if it's 0
+    if (!subject.valid())
+    {
+        bool dummies = true;
+        for (const auto& cell : row.cells)
+            if (cell.first.type != Symbol::Dummy) { dummies = false; break; }
+        if (dummies)
+        {
+            if (!near_zero(row.constant))
+            {
+                restore();
+                return 0;
+            }
+            subject = tag.marker;
+        }
+    }
+
+    if (!subject.valid())
+    {
+        if (!addWithArtificialVariable(row))
+        {
+            restore();
+            return 0;
+        }
+    }
+    else
+    {
+        row.solveFor(subject);
+        substitute(subject, row);
+        m_rows[subject] = std::move(row);
+    }
+
+    ConstraintId id = ++m_lastConstraint;
+    m_constraints[id] = {tag, strength};
+
+    optimize(m_objective);
+    return id;
+}
+
+
+bool Solver::remove(ConstraintId id)
+{
+    auto cit = m_constraints.find(id);
+    if (cit == m_constraints.end())
+        return false;
+    ConstraintInfo info = cit->second;
+    m_constraints.erase(cit);
+
+    // Take the errors out of the objective
+    if (info.tag.marker.type == Symbol::Error) removeMarkerEffects(info.tag.marker, info.strength);
+    if (info.tag.other.type == Symbol::Error)  removeMarkerEffects(info.tag.other, info.strength);
+
+    // Then the marker from the tableau
+    if (auto it = m_rows.find(info.tag.marker); it != m_rows.end())
+    {
+        m_rows.erase(it);
+    }
+    else
+    {
+        auto leaving = markerLeavingRow(info.tag.marker);
+        if (leaving == m_rows.end())
+        {
+            cerr << "- ERROR: Internal solver error (no row for the marker of a constraint)!\n";
+            return false;
+        }
+        Symbol s = leaving->first;
+        Row row = std::move(leaving->second);
+        m_rows.erase(leaving);
+        row.solveFor(s, info.tag.marker);
+        substitute(info.tag.marker, row);
+    }
+
+    optimize(m_objective);
+    return true;
+}
+
+
+bool Solver::addEditVariable(Variable v, double strength)
+{
+    if (hasEditVariable(v) || !varSymbol(v).valid())
+        return false;
+    if (strength >= strength::required)
+        strength = strength::strong;
+
+    ConstraintId id = add(Expression(v) == 0.0, strength);
+    if (!id) return false;
+
+    Edit edit;
+    edit.constraint = id;
+    edit.tag = m_constraints[id].tag;
+    m_edits[v.id] = edit;
+    return true;
+}
+
+
+bool Solver::removeEditVariable(Variable v)
+{
+    auto it = m_edits.find(v.id);
+    if (it == m_edits.end())
+        return false;
+    remove(it->second.constraint);
+    m_edits.erase(it);
+    return true;
+}
+
+
+void Solver::suggestValue(Variable v, double value)
+{
+    auto it = m_edits.find(v.id);
+    if (it == m_edits.end())
+        return;
+
+    Edit& edit = it->second;
+    double delta = value - edit.constant;
+    edit.constant = value;
+
+    // The edit constraint is: v - (error+) + (error-) == 0, so either of
+    // the error symbols being basic just shifts its row; otherwise the new
+    // value goes to every row that has the marker.
+    if (auto r = m_rows.find(edit.tag.marker); r != m_rows.end())
+    {
+        if (r->second.add(-delta) < 0) m_infeasible.push_back(r->first);
+    }
+    else if (auto r2 = m_rows.find(edit.tag.other); r2 != m_rows.end())
+    {
+        if (r2->second.add(delta) < 0) m_infeasible.push_back(r2->first);
+    }
+    else
+    {
+        for (auto& [s, row] : m_rows)
+        {
+            double coeff = row.coeffFor(edit.tag.marker);
+            if (coeff != 0 && row.add(delta * coeff) < 0 && s.type != Symbol::External)
+                m_infeasible.push_back(s);
+        }
+    }
+
+    dualOptimize();
+}
+
+
+void Solver::updateVariables()
+{
+    for (size_t i = 1; i < m_varSymbols.size(); ++i)
+    {
+        auto it = m_rows.find(m_varSymbols[i]);
+        m_values[i] = it != m_rows.end() ? it->second.constant : 0.0;
+    }
+}
+
+
+Solver::Row Solver::createRow(const Constraint& c, double strength, Tag& tag)
+{
+    Row row;
+    row.constant = c.expr.constant;
+
+    // Substitute the basic variables with their rows
+    for (const auto& [v, coeff] : c.expr.terms)
+    {
+        if (near_zero(coeff)) continue;
+        Symbol s = varSymbol(v);
+        if (!s.valid())
+        {
+            cerr << "- ERROR: Unknown variable in a constraint!\n";
+            return {};
+        }
+        if (auto it = m_rows.find(s); it != m_rows.end())
+            row.insert(it->second, coeff);
+        else
+            row.insert(s, coeff);
+    }
+
+    switch (c.op)
+    {
+    case Constraint::LE:
+    case Constraint::GE:
+    {
+        double coeff = c.op == Constraint::LE ? 1.0 : -1.0;
+        Symbol slack = newSymbol(Symbol::Slack);
+        tag.marker = slack;
+        row.insert(slack, coeff);
+        if (strength < strength::required)
+        {
+            Symbol error = newSymbol(Symbol::Error);
+            tag.other = error;
+            row.insert(error, -coeff);
+            m_objective.insert(error, strength);
+        }
+        break;
+    }
+    case Constraint::EQ:
+        if (strength < strength::required)
+        {
+            Symbol plus = newSymbol(Symbol::Error), minus = newSymbol(Symbol::Error);
+            tag.marker = plus;
+            tag.other = minus;
+            row.insert(plus, -1.0);
+            row.insert(minus, 1.0);
+            m_objective.insert(plus, strength);
+            m_objective.insert(minus, strength);
+        }
+        else
+        {
+            Symbol dummy = newSymbol(Symbol::Dummy);
+            tag.marker = dummy;
+            row.insert(dummy);
+        }
+        break;
+    }
+
+    if (row.constant < 0)
+        row.reverseSign();
+    return row;
+}
+
+
+Solver::Symbol Solver::chooseSubject(const Row& row, const Tag& tag) const
+{
+    for (const auto& cell : row.cells)
+        if (cell.first.type == Symbol::External)
+            return cell.first;
+
+    auto pivotable = [](const Symbol& s) { return s.type == Symbol::Slack || s.type == Symbol::Error; };
+    if (pivotable(tag.marker) && row.coeffFor(tag.marker) < 0) return tag.marker;
+    if (pivotable(tag.other) && row.coeffFor(tag.other) < 0) return tag.other;
+    return {};
+}
+
+
+bool Solver::addWithArtificialVariable(const Row& row)
+{
+    // Minimize an artificial variable set to the row; if it can get to 0,
+    // the row is satisfiable
+    Symbol art = newSymbol(Symbol::Slack);
+    m_rows[art] = row;
+    Row artificial = row;
+    m_artificial = &artificial;
+    optimize(artificial);
+    m_artificial = nullptr;
+    bool success = near_zero(artificial.constant);
+
+    // Pivot it out, if it's still basic
+    if (auto it = m_rows.find(art); it != m_rows.end())
+    {
+        Row r = std::move(it->second);
+        m_rows.erase(it);
+        if (r.cells.empty())
+            return success;
+        Symbol entering = anyPivotableSymbol(r);
+        if (!entering.valid())
+            return false;
+        r.solveFor(art, entering);
+        substitute(entering, r);
+        m_rows[entering] = std::move(r);
+    }
+
+    for (auto& entry : m_rows)
+        entry.second.remove(art);
+    m_objective.remove(art);
+    return success;
+}
+
+
+void Solver::substitute(const Symbol& s, const Row& row)
+{
+    for (auto& [basic, r] : m_rows)
+    {
+        r.substitute(s, row);
+        if (basic.type != Symbol::External && r.constant < 0)
+            m_infeasible.push_back(basic);
+    }
+    m_objective.substitute(s, row);
+    if (m_artificial) m_artificial->substitute(s, row);
+}
+
+
+bool Solver::optimize(Row& objective)
+{
+    for (;;)
+    {
+        Symbol entering = enteringSymbol(objective);
+        if (!entering.valid())
+            return true;
+
+        auto leaving = leavingRow(entering);
+        if (leaving == m_rows.end())
+        {
+            cerr << "- ERROR: Internal solver error (the objective is unbounded)!\n";
+            return false;
+        }
+        Symbol s = leaving->first;
+        Row row = std::move(leaving->second);
+        m_rows.erase(leaving);
+        row.solveFor(s, entering);
+        substitute(entering, row);
+        m_rows[entering] = std::move(row);
+    }
+}
+
+
+bool Solver::dualOptimize()
+{
+    while (!m_infeasible.empty())
+    {
+        Symbol leaving = m_infeasible.back();
+        m_infeasible.pop_back();
+
+        auto it = m_rows.find(leaving);
+        if (it == m_rows.end() || near_zero(it->second.constant) || it->second.constant >= 0)
+            continue;
+
+        Symbol entering = dualEnteringSymbol(it->second);
+        if (!entering.valid())
+        {
+            cerr << "- ERROR: Internal solver error (dual optimize failed)!\n";
+            m_infeasible.clear();
+            return false;
+        }
+        Row row = std::move(it->second);
+        m_rows.erase(it);
+        row.solveFor(leaving, entering);
+        substitute(entering, row);
+        m_rows[entering] = std::move(row);
+    }
+    return true;
+}
+
+
+Solver::Symbol Solver::enteringSymbol(const Row& objective) const
+{
+    for (const auto& [s, coeff] : objective.cells)
+        if (s.type != Symbol::Dummy && coeff < 0)
+            return s;
+    return {};
+}
+
+
+Solver::Symbol Solver::dualEnteringSymbol(const Row& row) const
+{
+    Symbol entering;
+    double ratio = std::numeric_limits<double>::max();
+    for (const auto& [s, coeff] : row.cells)
+    {
+        if (coeff > 0 && s.type != Symbol::Dummy)
+        {
+            double r = m_objective.coeffFor(s) / coeff;
+            if (r < ratio)
+            {
+                ratio = r;
+                entering = s;
+            }
+        }
+    }
+    return entering;
+}
+
+
+Solver::Symbol Solver::anyPivotableSymbol(const Row& row) const
+{
+    for (const auto& cell : row.cells)
+        if (cell.first.type == Symbol::Slack || cell.first.type == Symbol::Error)
+            return cell.first;
+    return {};
+}
+
+
+std::map<Solver::Symbol, Solver::Row>::iterator Solver::leavingRow(const Symbol& entering)
+{
+    double ratio = std::numeric_limits<double>::max();
+    auto found = m_rows.end();
+    for (auto it = m_rows.begin(); it != m_rows.end(); ++it)
+    {
+        if (it->first.type == Symbol::External) continue;
+        double coeff = it->second.coeffFor(entering);
+        if (coeff < 0)
+        {
+            double r = -it->second.constant / coeff;
+            if (r < ratio)
+            {
+                ratio = r;
+                found = it;
+            }
+        }
+    }
+    return found;
+}
+
+
+std::map<Solver::Symbol, Solver::Row>::iterator Solver::markerLeavingRow(const Symbol& marker)
+{
+    const double max = std::numeric_limits<double>::max();
+    double r1 = max, r2 = max;
+    auto end = m_rows.end(), first = end, second = end, third = end;
+    for (auto it = m_rows.begin(); it != end; ++it)
+    {
+        double c = it->second.coeffFor(marker);
+        if (c == 0) continue;
+        if (it->first.type == Symbol::External)
+        {
+            third = it;
+        }
+        else if (c < 0)
+        {
+            double r = -it->second.constant / c;
+            if (r < r1) { r1 = r; first = it; }
+        }
+        else
+        {
+            double r = it->second.constant / c;
+            if (r < r2) { r2 = r; second = it; }
+        }
+    }
+    return first != end ? first : second != end ? second : third;
+}
+
+
+void Solver::removeMarkerEffects(const Symbol& marker, double strength)
+{
+    if (auto it = m_rows.find(marker); it != m_rows.end())
+        m_objective.insert(it->second, -strength);
+    else
+        m_objective.insert(marker, -strength);
+}
+
+} // namespace cassowary
+} // namespace sfw
@@ -0,0 +1,86 @@
+#include "sfw/util/worker_pool.hpp"
+
+namespace sfw
+{
+
+WorkerPool::WorkerPool(unsigned threads)
+{
+    m_threads.reserve(threads);
+    for (unsigned i = 0; i < threads; ++i)
+        m_threads.emplace_back([this] { work(); });
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for (auto& t : m_threads)
+        t.join();
+}
+
+
+void WorkerPool::run(size_t count, const std::function<void(size_t)>& job)
+{
+    if (!count) return;
+
+    {
+        std::lock_guard lock(m_mutex);
+        m_job = &job;
+        m_count = count;
+        m_next = 0;
+        m_finished = 0;
+        ++m_generation;
+        ++m_active; // (The calling thread.)
+    }
+    m_wake.notify_all();
+
+    drain();
+
+    std::unique_lock lock(m_mutex);
+    --m_active;
+    // All done, and no thread is still looking at this batch:
+    m_done.wait(lock, [this] { return m_finished == m_count && m_active == 0; });
+    m_job = nullptr;
+    m_count = 0;
+}
+
+
+void WorkerPool::work()
+{
+    unsigned seen = 0;
+    for (;;)
+    {
+        {
+            std::unique_lock lock(m_mutex);
+            m_wake.wait(lock, [&] { return m_stop || (m_generation != seen && m_job); });
+            if (m_stop) return;
+            seen = m_generation;
+            ++m_active;
+        }
+
+        drain();
+
+        {
+            std::lock_guard lock(m_mutex);
+            --m_active;
+        }
+        m_done.notify_all();
+    }
+}
+
+
+void WorkerPool::drain()
+{
+    for (size_t i; (i = m_next++) < m_count;)
+    {
+        (*m_job)(i);
+
+        std::lock_guard lock(m_mutex);
+        ++m_finished;
+    }
+}
+
+} // namespace
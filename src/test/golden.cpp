@@ -0,0 +1,154 @@
+// Golden-image check of the software renderer (gfx::Rasterizer)
+//
+// Renders a fixed scene (widget boxes, a sprite and SDF text) on the CPU,
+// and compares it to a reference image, pixel by pixel.
+//
+// Usage: sfw-golden [--update] [reference.png]
+//	(The default reference is test/golden/reference.png; --update (re)writes
+//	it from the current rendering, after checking that it looks right!)
+//
+// Build it headless, with SDF text (`make HEADLESS=1 SDF=1 sfw-golden`), so that
+// nothing needs a GL context. (The theme texture, the sprite and the glyphs
+// are all sampled from system memory then; see gfx::Rasterizer.)
+
+#include "sfw/GUI.hpp"
+#include "sfw/Gfx/Rasterizer.hpp"
+#include "sfw/Gfx/SdfFont.hpp"
+
+#include <SFML/Graphics.hpp>
+
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include <iostream>
+using namespace std;
+
+namespace {
+
+	const sf::Vector2u SIZE = {240, 160};
+	const int TOLERANCE = 2; // Per channel (the SDF coverage is float math)
+
+	// A sprite of a generated checkerboard
+	class SpriteScene : public sfw::gfx::Drawable
+	{
+	public:
+		SpriteScene()
+		{
+			m_image.create({16, 16}, sf::Color(40, 90, 160));
+			for (unsigned y = 0; y < 16; ++y)
+				for (unsigned x = 0; x < 16; ++x)
+					if ((x / 4 + y / 4) % 2)
+						m_image.setPixel({x, y}, sf::Color(230, 200, 60, 192));
+			// (Not needed by the rasterizer, and would need a GL context.)
+			if (!sfw::gfx::Renderer::headless)
+				(void)m_texture.loadFromImage(m_image);
+		}
+
+		const sf::Texture& texture() const { return m_texture; }
+		const sf::Image& image() const { return m_image; }
+
+	protected:
+		void draw(const sfw::gfx::RenderContext& ctx) const override
+		{
+			sf::Sprite sprite(m_texture, {{0, 0}, {16, 16}});
+			sprite.setPosition({180, 16});
+			sprite.setScale({3, 3});
+			ctx.renderer.draw(sprite, ctx.props);
+		}
+
+	private:
+		sf::Image m_image;
+		sf::Texture m_texture;
+	};
+
+	sf::Image render()
+	{
+		using namespace sfw;
+
+		if (!gfx::SdfFont::available) {
+			cerr << "- ERROR: Built without SDF text (SFW_SDF_TEXT), which the scene needs!\n";
+			exit(EXIT_FAILURE);
+		}
+
+		// Everything (incl. the font) from the repo, so the result only
+		// depends on the code
+		Theme::sdfText = true; // Before the widgets, as it changes the text metrics, too
+		Theme::textSize = 12;
+		if (!Theme::loadFont("asset/font/default.ttf") || !Theme::loadTexture("asset/texture/default.png")) {
+			cerr << "- ERROR: Failed to load the theme (run it from the root of the repo)!\n";
+			exit(EXIT_FAILURE);
+		}
+
+		VBox root;
+		root.add(new Label("Golden image: Boxes & text"));
+		root.add(new Button("Button"));
+		root.add(new TextBox(120))->setText("AVAST, kerning!");
+		root.add(new ProgressBar(120))->setValue(40);
+		root.add(new Label("Small text, big text"))->setTextSize(9);
+		root.setPosition(8, 8);
+		root.updateLayout();
+
+		SpriteScene sprite;
+
+		gfx::Rasterizer rasterizer(SIZE);
+		rasterizer.setTextureImage(sprite.texture(), sprite.image());
+		rasterizer.clear(sf::Color(230, 232, 224));
+		rasterizer.render(root);
+		rasterizer.render(sprite);
+		return rasterizer.toImage();
+	}
+
+} // namespace
+
+
+int main(int argc, char* argv[])
+{
+	bool update = false;
+	string reference = "test/golden/reference.png";
+	for (int i = 1; i < argc; ++i) {
+		if (!strcmp(argv[i], "--update")) update = true;
+		else reference = argv[i];
+	}
+
+	sf::Image actual = render();
+
+	if (update) {
+		if (!actual.saveToFile(reference)) {
+			cerr << "- ERROR: Failed to save \"" << reference << "\"!\n";
+			return EXIT_FAILURE;
+		}
+		cout << "Reference image updated: " << reference << "\n";
+		return EXIT_SUCCESS;
+	}
+
+	sf::Image expected;
+	if (!expected.loadFromFile(reference)) {
+		cerr << "- ERROR: No reference image \"" << reference << "\" (use --update to make one)!\n";
+		return EXIT_FAILURE;
+	}
+	if (expected.getSize() != actual.getSize()) {
+		cerr << "- ERROR: The reference image has a different size!\n";
+		return EXIT_FAILURE;
+	}
+
+	size_t mismatches = 0;
+	const std::uint8_t* a = actual.getPixelsPtr();
+	const std::uint8_t* e = expected.getPixelsPtr();
+	for (size_t i = 0; i < (size_t)SIZE.x * SIZE.y; ++i) {
+		for (int ch = 0; ch < 4; ++ch) {
+			if (abs((int)a[i * 4 + ch] - (int)e[i * 4 + ch]) > TOLERANCE) {
+				++mismatches;
+				break;
+			}
+		}
+	}
+
+	if (mismatches) {
+		string saved = reference.substr(0, reference.rfind('.')) + "-actual.png";
+		(void)actual.saveToFile(saved);
+		cerr << "- FAILED: " << mismatches << " pixels differ from the reference (see \"" << saved << "\")!\n";
+		return EXIT_FAILURE;
+	}
+	cout << "OK, the rendering matches the reference.\n";
+	return EXIT_SUCCESS;
+}
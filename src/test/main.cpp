@@ -7,6 +7,7 @@
 #include <thread>
 #include <chrono>
 #include <cassert>
+#include <cmath>
 using namespace std;
 
 
@@ -86,6 +87,7 @@ int main()
 #endif
 	});
 	circlevista->setSize(100,100);
+	circlevista->setCaching(true); // It's static, and loads its texture in the hook...
 
 	// #168: Form supporting any left-hand-side widget as "label"
 	auto labelbox = new VBox;
@@ -103,6 +105,38 @@ int main()
 	//#171, template-move also for the "label":
 	gh171form->add(Label("tmpLabel"), Label("#171(tmp,tmp) OK too!"));
 
+	// Static custom geometry, uploaded once (Canvas), vs. the DrawHost above
+	std::vector<sf::Vertex> wheel;
+	for (int i = 0; i < 36; ++i) {
+		auto rim = [](int n) { float a = (float)n * 3.14159265f / 18; return sf::Vector2f(50 + 48 * std::cos(a), 50 + 48 * std::sin(a)); };
+		auto hue = [](int n) { return sf::Color((std::uint8_t)(n * 7), (std::uint8_t)(255 - n * 7), 160); };
+		wheel.emplace_back(sf::Vector2f(50, 50), sf::Color::White);
+		wheel.emplace_back(rim(i), hue(i));
+		wheel.emplace_back(rim(i + 1), hue(i + 1));
+	}
+	test_hbox->add((new Canvas({100, 100}))->setGeometry(wheel, sf::PrimitiveType::Triangles));
+
+	// Flex: fixed height, with the free space going to the middle one
+	auto flexcol = test_hbox->add(new Flex(Vertical));
+	flexcol->setFixedSize({0, 100})->setAlign(Flex::Align::Stretch);
+	flexcol->add(Label("Flex top"));
+	flexcol->setFlex(flexcol->add(Button("Grows")), 1);
+	flexcol->add(Label("Flex bottom"));
+
+	// Grid: 3 columns, with a header spanning all of them
+	auto grid = test_hbox->add(new Grid(3));
+	grid->setSpan(grid->add(Label("Grid (3 cols)")), 3);
+	for (int i = 1; i <= 6; ++i)
+		grid->add(Label(std::string(i, '#')));
+
+	// ConstraintLayout: "Cancel" right of "OK", and a note centered below them
+	auto cl = test_hbox->add(new ConstraintLayout);
+	auto okbtn = cl->add(Button("OK")), cancelbtn = cl->add(Button("Cancel"));
+	auto note = cl->add(Label("(constraints)"));
+	cl->addConstraint(cl->anchors(cancelbtn).left == cl->anchors(okbtn).right() + 10);
+	cl->addConstraint(cl->anchors(note).top == cl->anchors(okbtn).bottom() + 5);
+	cl->addConstraint(cl->anchors(note).centerX() == cl->anchors().centerX());
+
 	//!! This is not yet supported (nor separators...):
 	//!!test_hbox->add(new Form)->add("This is just some text on its own.");
 
@@ -438,6 +472,7 @@ int main()
 		->add("Default", themes[DEFAULT_THEME].bgColor)
 		->setCallback([&](auto* w) {
 			Theme::bgColor = w->current();
+			demo.damage(); // The GUI can't know about Theme changes made this way
 		})
 	);
 
@@ -446,7 +481,7 @@ int main()
 	hbox4->add(sfw::Label("Clear background"));
 	// + a uselessly convoluted name-lookup through its own widget pointer, to check
 	// the get() name fix of #200 (assuming CheckBox still has its "real" get():
-	hbox4->add(sfw::CheckBox([&](auto* w) { Theme::clearBackground = ((sfw::CheckBox*)w->getWidget("x"))->get(); }, true), "x");
+	hbox4->add(sfw::CheckBox([&](auto* w) { Theme::clearBackground = ((sfw::CheckBox*)w->getWidget("x"))->get(); demo.damage(); }, true), "x");
 
 	// "GUI::close" button -- should NOT close the window:
 	demo.add(sfw::Button("Close the GUI!", [&] { demo.close(); }));
@@ -518,7 +553,7 @@ void background_thread_main(sfw::GUI& gui)
 		sampletext_angle = sf::degrees(n*2.f);
 
 		if (n%20 != 0)
-			gui.setPosition(float(10 + (n/20)%10), float(10 + (n/20)%10));
+			gui.post([&gui, n] { gui.setPosition(float(10 + (n/20)%10), float(10 + (n/20)%10)); });
 //		if (n%20) continue;
 //		gui.setPosition(float(10 + (n/20)%10), float(10 + (n/20)%10));
 	}